@@ -1,5 +1,6 @@
 #include <node_api.h>
 #include <assert.h>
+#include "producers.h"
 
 napi_value RunCallback(napi_env env, const napi_callback_info info) {
   napi_status status;
@@ -19,10 +20,74 @@ napi_value RunCallback(napi_env env, const napi_callback_info info) {
   status = napi_get_global(env, &global);
   assert(status == napi_ok);
 
+  // an exception thrown by cb stays pending for our caller
   napi_value result;
-  status = napi_call_function(env, global, cb, 1, argv, &result);
+  napi_call_function(env, global, cb, 1, argv, &result);
+
+  return nullptr;
+}
+
+// The receiver for runCallbackBatch(), looked up once in Init().
+// Per thread, as every worker loading the addon has its own global.
+static thread_local napi_ref global_ref;
+
+// runCallbackBatch(cb, n) calls cb once with an array of n messages
+// instead of n times with one. Each crossing into JS costs far more
+// than an array element, and the message string is only made once
+// per batch, then shared by every entry.
+napi_value RunCallbackBatch(napi_env env, const napi_callback_info info) {
+  napi_status status;
+
+  size_t argc = 2;
+  napi_value args[2];
+  status = napi_get_cb_info(env, info, &argc, args, nullptr, nullptr);
+  assert(status == napi_ok);
+
+  napi_value cb = args[0];
+
+  napi_valuetype valuetype;
+  status = napi_typeof(env, cb, &valuetype);
+  assert(status == napi_ok);
+  if (valuetype != napi_function) {
+    napi_throw_type_error(env, nullptr, "cb must be a function");
+    return nullptr;
+  }
+
+  // napi_get_value_uint32() would wrap -1 to 2^32 - 1 and truncate
+  // 1.5, so check the number itself
+  const double kMaxBatch = 1e7;
+  double requested;
+  status = napi_get_value_double(env, args[1], &requested);
+  if (status != napi_ok || !(requested >= 0 && requested <= kMaxBatch) ||
+      requested != static_cast<double>(static_cast<uint32_t>(requested))) {
+    napi_throw_range_error(env, nullptr, "n must be an integer from 0 to 10000000");
+    return nullptr;
+  }
+  uint32_t n = static_cast<uint32_t>(requested);
+
+  napi_value message;
+  status = napi_create_string_utf8(env, "hello world", NAPI_AUTO_LENGTH, &message);
+  assert(status == napi_ok);
+
+  napi_value global;
+  status = napi_get_reference_value(env, global_ref, &global);
   assert(status == napi_ok);
 
+  // filled in order rather than preallocated, so that it keeps fast
+  // elements however large it is
+  napi_value argv[1];
+  status = napi_create_array(env, argv);
+  assert(status == napi_ok);
+
+  for (uint32_t i = 0; i < n; i++) {
+    status = napi_set_element(env, argv[0], i, message);
+    assert(status == napi_ok);
+  }
+
+  // an exception thrown by cb stays pending for our caller
+  napi_value result;
+  napi_call_function(env, global, cb, 1, argv, &result);
+
   return nullptr;
 }
 
@@ -31,6 +96,24 @@ napi_value Init(napi_env env, napi_value exports) {
   napi_status status =
       napi_create_function(env, "", NAPI_AUTO_LENGTH, RunCallback, nullptr, &new_exports);
   assert(status == napi_ok);
+
+  napi_value batch;
+  status = napi_create_function(env, "runCallbackBatch", NAPI_AUTO_LENGTH,
+                                RunCallbackBatch, nullptr, &batch);
+  assert(status == napi_ok);
+
+  status = napi_set_named_property(env, new_exports, "runCallbackBatch", batch);
+  assert(status == napi_ok);
+
+  napi_value global;
+  status = napi_get_global(env, &global);
+  assert(status == napi_ok);
+
+  status = napi_create_reference(env, global, 1, &global_ref);
+  assert(status == napi_ok);
+
+  status = Producers::Init(env, new_exports);
+  assert(status == napi_ok);
   return new_exports;
 }
 
@@ -3,3 +3,18 @@ var addon = require('bindings')('addon');
 addon(function(msg){
   console.log(msg); // 'hello world'
 });
+
+// many messages in one call
+addon.runCallbackBatch(function(msgs){
+  console.log(msgs.length); // 3
+}, 3);
+
+// results from native threads, at most 64 of them waiting at a time
+var received = 0;
+var producers = addon.startProducers({ threads: 2, count: 1000, queueSize: 64 },
+  function(results){
+    received += results.length;
+  });
+setTimeout(function(){
+  console.log(received, producers.stats().maxDepth <= 64); // 2000 true
+}, 100);
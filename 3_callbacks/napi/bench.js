@@ -0,0 +1,34 @@
+// Messages delivered per second by one addon(cb) call per message,
+// and by runCallbackBatch(cb, n) for a few batch sizes.
+var addon = require('bindings')('addon');
+
+var count = Number(process.argv[2]) || 1000000;
+var received = 0;
+
+function onMessage(msg) {
+  received++;
+}
+
+function onMessages(msgs) {
+  received += msgs.length;
+}
+
+function report(name, start) {
+  var ns = Number(process.hrtime.bigint() - start);
+  console.log(name + ': ' + (received / ns * 1e3).toFixed(2) + ' M messages/s');
+  received = 0;
+}
+
+var start = process.hrtime.bigint();
+for (var i = 0; i < count; i++) {
+  addon(onMessage);
+}
+report('addon(cb)', start);
+
+[1, 16, 256, 4096].forEach(function(n) {
+  start = process.hrtime.bigint();
+  for (var i = 0; i < count; i += n) {
+    addon.runCallbackBatch(onMessages, n);
+  }
+  report('runCallbackBatch(cb, ' + n + ')', start);
+});
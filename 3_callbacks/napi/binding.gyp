@@ -2,7 +2,7 @@
   "targets": [
     {
       "target_name": "addon",
-      "sources": [ "addon.cc" ]
+      "sources": [ "addon.cc", "producers.cc" ]
     }
   ]
 }
@@ -0,0 +1,394 @@
+#include "producers.h"
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+
+Producers::Producers()
+    : count_(0),
+      queue_size_(0),
+      policy_(kBlock),
+      tsfn_(nullptr),
+      self_(nullptr),
+      running_(true),
+      wrapper_gone_(false),
+      stopping_(false),
+      max_depth_(0),
+      enqueued_(0),
+      delivered_(0),
+      dropped_(0),
+      coalesced_(0),
+      calls_(0) {}
+
+Producers::~Producers() {}
+
+// The handle startProducers() returns is tagged with this. stop()
+// and stats() are plain functions on it, which JS can call with any
+// receiver, so Unwrap() checks the tag.
+static const napi_type_tag kProducersTag = {
+  0x70726f6475636572ULL, 0x9e3779b97f4a7c15ULL
+};
+
+#define DECLARE_NAPI_METHOD(name, func)                          \
+  { name, 0, func, 0, 0, 0, napi_default, 0 }
+
+napi_status Producers::Init(napi_env env, napi_value exports) {
+  napi_status status;
+
+  napi_value start;
+  status = napi_create_function(
+      env, "startProducers", NAPI_AUTO_LENGTH, Start, nullptr, &start);
+  if (status != napi_ok) return status;
+
+  return napi_set_named_property(env, exports, "startProducers", start);
+}
+
+// Reads options[name] into `*value` if it is a positive integer no
+// larger than `max`; false after throwing if it is anything else.
+static bool GetSizeOption(napi_env env,
+                          napi_value options,
+                          const char* name,
+                          size_t max,
+                          size_t* value) {
+  napi_status status;
+
+  napi_value option;
+  status = napi_get_named_property(env, options, name, &option);
+  if (status != napi_ok) return false;
+
+  napi_valuetype valuetype;
+  status = napi_typeof(env, option, &valuetype);
+  assert(status == napi_ok);
+  if (valuetype == napi_undefined) return true;
+
+  double number;
+  status = napi_get_value_double(env, option, &number);
+  if (status != napi_ok || !(number >= 1 && number <= max) ||
+      number != static_cast<double>(static_cast<size_t>(number))) {
+    char message[64];
+    snprintf(message, sizeof(message), "%s must be an integer from 1 to %zu",
+             name, max);
+    napi_throw_range_error(env, nullptr, message);
+    return false;
+  }
+
+  *value = static_cast<size_t>(number);
+  return true;
+}
+
+// startProducers({ threads, count, queueSize, policy }, cb) starts
+// `threads` threads which produce `count` results each.
+napi_value Producers::Start(napi_env env, napi_callback_info info) {
+  napi_status status;
+
+  size_t argc = 2;
+  napi_value args[2];
+  status = napi_get_cb_info(env, info, &argc, args, nullptr, nullptr);
+  assert(status == napi_ok);
+
+  napi_valuetype valuetype;
+  status = napi_typeof(env, args[1], &valuetype);
+  assert(status == napi_ok);
+  if (valuetype != napi_function) {
+    napi_throw_type_error(env, nullptr, "cb must be a function");
+    return nullptr;
+  }
+
+  size_t threads = 2;
+  size_t count = 1000;
+  size_t queue_size = 64;
+  Policy policy = kBlock;
+
+  status = napi_typeof(env, args[0], &valuetype);
+  assert(status == napi_ok);
+  if (valuetype == napi_object) {
+    if (!GetSizeOption(env, args[0], "threads", 64, &threads) ||
+        !GetSizeOption(env, args[0], "count", 1e9, &count) ||
+        !GetSizeOption(env, args[0], "queueSize", 1e6, &queue_size)) {
+      return nullptr;
+    }
+
+    napi_value option;
+    status = napi_get_named_property(env, args[0], "policy", &option);
+    if (status != napi_ok) return nullptr;
+
+    status = napi_typeof(env, option, &valuetype);
+    assert(status == napi_ok);
+    if (valuetype != napi_undefined) {
+      char name[16] = "";
+      napi_get_value_string_utf8(env, option, name, sizeof(name), nullptr);
+      if (strcmp(name, "block") == 0) {
+        policy = kBlock;
+      } else if (strcmp(name, "drop") == 0) {
+        policy = kDrop;
+      } else if (strcmp(name, "coalesce") == 0) {
+        policy = kCoalesce;
+      } else {
+        napi_throw_type_error(
+            env, nullptr, "policy must be 'block', 'drop' or 'coalesce'");
+        return nullptr;
+      }
+    }
+  } else if (valuetype != napi_undefined) {
+    napi_throw_type_error(env, nullptr, "options must be an object");
+    return nullptr;
+  }
+
+  napi_value handle;
+  status = napi_create_object(env, &handle);
+  assert(status == napi_ok);
+
+  napi_property_descriptor properties[] = {
+      DECLARE_NAPI_METHOD("stop", Stop),
+      DECLARE_NAPI_METHOD("stats", GetStats),
+  };
+  status = napi_define_properties(
+      env, handle, sizeof(properties) / sizeof(*properties), properties);
+  assert(status == napi_ok);
+
+  Producers* obj = new Producers();
+  obj->count_ = count;
+  obj->queue_size_ = queue_size;
+  obj->policy_ = policy;
+
+  status = napi_wrap(env,
+                     handle,
+                     reinterpret_cast<void*>(obj),
+                     Producers::Destructor,
+                     nullptr,  // finalize_hint
+                     &obj->self_);
+  assert(status == napi_ok);
+
+  status = napi_type_tag_object(env, handle, &kProducersTag);
+  assert(status == napi_ok);
+
+  status = napi_reference_ref(env, obj->self_, nullptr);
+  assert(status == napi_ok);
+
+  napi_value resource_name;
+  status = napi_create_string_utf8(
+      env, "Producers", NAPI_AUTO_LENGTH, &resource_name);
+  assert(status == napi_ok);
+
+  // Only empty-to-non-empty transitions of our own queue are sent
+  // through the function's queue, so that one needs no bound.
+  status = napi_create_threadsafe_function(env,
+                                           args[1],
+                                           nullptr,
+                                           resource_name,
+                                           0,  // max_queue_size
+                                           threads,
+                                           obj,  // thread_finalize_data
+                                           Finalize,
+                                           obj,  // context
+                                           CallJs,
+                                           &obj->tsfn_);
+  assert(status == napi_ok);
+
+  for (size_t i = 0; i < threads; i++) {
+    obj->threads_.emplace_back(&Producers::Produce, obj, i);
+  }
+
+  return handle;
+}
+
+void Producers::Produce(size_t index) {
+  for (size_t i = 0; i < count_; i++) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (stopping_) break;
+    }
+    Enqueue(static_cast<double>(index * count_ + i));
+  }
+
+  napi_release_threadsafe_function(tsfn_, napi_tsfn_release);
+}
+
+void Producers::Enqueue(double result) {
+  bool wake;
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (queue_.size() >= queue_size_) {
+      switch (policy_) {
+        case kBlock:
+          not_full_.wait(lock, [this] {
+            return queue_.size() < queue_size_ || stopping_;
+          });
+          if (stopping_) return;
+          break;
+        case kDrop:
+          dropped_++;
+          return;
+        case kCoalesce:
+          queue_.back() = result;
+          coalesced_++;
+          return;
+      }
+    }
+
+    // otherwise a call is already on its way and will take this too
+    wake = queue_.empty();
+    queue_.push_back(result);
+    enqueued_++;
+    if (queue_.size() > max_depth_) max_depth_ = queue_.size();
+  }
+
+  if (wake) {
+    napi_status status =
+        napi_call_threadsafe_function(tsfn_, nullptr, napi_tsfn_nonblocking);
+    if (status == napi_closing) {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stopping_ = true;
+    }
+  }
+}
+
+// Runs on the main thread, and hands JS everything queued so far.
+void Producers::CallJs(napi_env env, napi_value cb, void* context, void* /*data*/) {
+  Producers* obj = static_cast<Producers*>(context);
+
+  std::deque<double> results;
+  {
+    std::lock_guard<std::mutex> lock(obj->mutex_);
+    results.swap(obj->queue_);
+    obj->delivered_ += results.size();
+    if (!results.empty()) obj->calls_++;
+  }
+  obj->not_full_.notify_all();
+
+  // env is NULL while the environment is torn down
+  if (env == nullptr || results.empty()) return;
+
+  // Calls into a worker that is being terminated fail; the results
+  // are dropped then, like everything else it had queued.
+  napi_status status;
+
+  napi_value argv[1];
+  status = napi_create_array(env, argv);
+  if (status != napi_ok) return;
+
+  for (size_t i = 0; i < results.size(); i++) {
+    napi_value result;
+    status = napi_create_double(env, results[i], &result);
+    if (status != napi_ok) return;
+
+    status = napi_set_element(env, argv[0], static_cast<uint32_t>(i), result);
+    if (status != napi_ok) return;
+  }
+
+  napi_value undefined;
+  status = napi_get_undefined(env, &undefined);
+  if (status != napi_ok) return;
+
+  // an exception thrown by cb is reported as uncaught
+  napi_call_function(env, undefined, cb, 1, argv, nullptr);
+}
+
+// Runs on the main thread once every producer has finished.
+void Producers::Finalize(napi_env env, void* data, void* /*hint*/) {
+  Producers* obj = static_cast<Producers*>(data);
+
+  {
+    std::lock_guard<std::mutex> lock(obj->mutex_);
+    obj->stopping_ = true;
+  }
+  obj->not_full_.notify_all();
+
+  for (size_t i = 0; i < obj->threads_.size(); i++) {
+    obj->threads_[i].join();
+  }
+  obj->running_ = false;
+
+  if (obj->wrapper_gone_) {
+    delete obj;
+  } else {
+    napi_reference_unref(env, obj->self_, nullptr);
+  }
+}
+
+void Producers::Destructor(napi_env env, void* nativeObject, void* /*finalize_hint*/) {
+  Producers* obj = static_cast<Producers*>(nativeObject);
+  napi_delete_reference(env, obj->self_);
+
+  // only before Finalize() while the environment is torn down
+  obj->wrapper_gone_ = true;
+  if (!obj->running_) delete obj;
+}
+
+// The Producers behind `this`, or NULL after throwing a TypeError.
+static Producers* Unwrap(napi_env env, napi_callback_info info) {
+  napi_value jsthis;
+  napi_status status =
+      napi_get_cb_info(env, info, nullptr, nullptr, &jsthis, nullptr);
+  assert(status == napi_ok);
+
+  bool is_producers;
+  status = napi_check_object_type_tag(env, jsthis, &kProducersTag, &is_producers);
+  if (status != napi_ok || !is_producers) {
+    napi_throw_type_error(env, nullptr, "expected a producers handle");
+    return nullptr;
+  }
+
+  Producers* obj;
+  status = napi_unwrap(env, jsthis, reinterpret_cast<void**>(&obj));
+  assert(status == napi_ok);
+  return obj;
+}
+
+// stop() makes the producers stop after their current result.
+napi_value Producers::Stop(napi_env env, napi_callback_info info) {
+  Producers* obj = Unwrap(env, info);
+  if (obj == nullptr) return nullptr;
+
+  {
+    std::lock_guard<std::mutex> lock(obj->mutex_);
+    obj->stopping_ = true;
+  }
+  obj->not_full_.notify_all();
+
+  return nullptr;
+}
+
+napi_value Producers::GetStats(napi_env env, napi_callback_info info) {
+  napi_status status;
+
+  Producers* obj = Unwrap(env, info);
+  if (obj == nullptr) return nullptr;
+
+  struct {
+    const char* name;
+    double value;
+  } fields[] = {
+      { "depth", 0 },
+      { "maxDepth", 0 },
+      { "enqueued", 0 },
+      { "delivered", 0 },
+      { "dropped", 0 },
+      { "coalesced", 0 },
+      { "calls", 0 },
+  };
+  {
+    std::lock_guard<std::mutex> lock(obj->mutex_);
+    fields[0].value = static_cast<double>(obj->queue_.size());
+    fields[1].value = static_cast<double>(obj->max_depth_);
+    fields[2].value = obj->enqueued_;
+    fields[3].value = obj->delivered_;
+    fields[4].value = obj->dropped_;
+    fields[5].value = obj->coalesced_;
+    fields[6].value = obj->calls_;
+  }
+
+  napi_value stats;
+  status = napi_create_object(env, &stats);
+  assert(status == napi_ok);
+
+  for (size_t i = 0; i < sizeof(fields) / sizeof(*fields); i++) {
+    napi_value value;
+    status = napi_create_double(env, fields[i].value, &value);
+    assert(status == napi_ok);
+
+    status = napi_set_named_property(env, stats, fields[i].name, value);
+    assert(status == napi_ok);
+  }
+
+  return stats;
+}
@@ -0,0 +1,71 @@
+#ifndef TEST_ADDONS_NAPI_3_CALLBACKS_PRODUCERS_H_
+#define TEST_ADDONS_NAPI_3_CALLBACKS_PRODUCERS_H_
+
+#include <node_api.h>
+#include <stddef.h>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/*
+Native threads producing results for a JS callback:
+
+  var producers = addon.startProducers(options, function(results) {});
+
+Results wait in a queue of at most `queueSize` entries, and reach JS
+through a napi_threadsafe_function, so producers never touch the
+event loop. The callback gets every result queued since its last
+call as one array. What a producer does when the queue is full is
+the `policy`:
+
+  'block'     wait until the callback has drained the queue
+  'drop'      drop the new result
+  'coalesce'  replace the newest queued result with the new one
+
+producers.stats() reports the queue depth and what happened to the
+results so far; producers.stop() makes the threads stop early.
+*/
+class Producers {
+ public:
+  enum Policy { kBlock, kDrop, kCoalesce };
+
+  static napi_status Init(napi_env env, napi_value exports);
+
+ private:
+  Producers();
+  ~Producers();
+
+  static napi_value Start(napi_env env, napi_callback_info info);
+  static napi_value Stop(napi_env env, napi_callback_info info);
+  static napi_value GetStats(napi_env env, napi_callback_info info);
+  static void Destructor(napi_env env, void* nativeObject, void* finalize_hint);
+  static void CallJs(napi_env env, napi_value cb, void* context, void* data);
+  static void Finalize(napi_env env, void* data, void* hint);
+
+  void Produce(size_t index);
+  void Enqueue(double result);
+
+  size_t count_;        // results per thread
+  size_t queue_size_;
+  Policy policy_;
+  std::vector<std::thread> threads_;
+  napi_threadsafe_function tsfn_;
+  napi_ref self_;       // keeps the wrapper alive while threads run
+  bool running_;        // until Finalize(), on the main thread
+  bool wrapper_gone_;   // set by Destructor(), on the main thread
+
+  std::mutex mutex_;    // guards everything below
+  std::condition_variable not_full_;
+  std::deque<double> queue_;
+  bool stopping_;
+  size_t max_depth_;
+  double enqueued_;
+  double delivered_;
+  double dropped_;
+  double coalesced_;
+  double calls_;
+};
+
+#endif  // TEST_ADDONS_NAPI_3_CALLBACKS_PRODUCERS_H_
@@ -1,5 +1,7 @@
 #include <node_api.h>
 #include <assert.h>
+#include "columns.h"
+#include "object_template.h"
 
 napi_value CreateObject(napi_env env, const napi_callback_info info) {
   napi_status status;
@@ -24,6 +26,12 @@ napi_value Init(napi_env env, napi_value exports) {
   napi_status status =
       napi_create_function(env, "", NAPI_AUTO_LENGTH, CreateObject, nullptr, &new_exports);
   assert(status == napi_ok);
+
+  status = ObjectTemplate::Init(env, new_exports);
+  assert(status == napi_ok);
+
+  status = Columns::Init(env, new_exports);
+  assert(status == napi_ok);
   return new_exports;
 }
 
@@ -2,4 +2,23 @@ var addon = require('bindings')('addon');
 
 var obj1 = addon('hello');
 var obj2 = addon('world');
-console.log(obj1.msg+' '+obj2.msg); // 'hello world'
\ No newline at end of file
+console.log(obj1.msg+' '+obj2.msg); // 'hello world'
+
+// many objects of one layout, all sharing the same shape
+var createRecord = addon.defineTemplate({ msg: 'string', id: 'number' });
+var rec = createRecord('hello', 1);
+console.log(rec.msg+' '+rec.id); // 'hello 1'
+
+// many objects from columns, in one call
+var bytes = Buffer.from('helloworld');
+var columns = {
+  id: new Int32Array([1, 2]),
+  msg: { data: new Uint8Array(bytes.buffer, bytes.byteOffset, bytes.length),
+         offsets: new Uint32Array([0, 5, 10]) },
+};
+var objs = addon.createObjects(columns);
+console.log(objs[1].msg+' '+objs[1].id); // 'world 2'
+
+// or views that only decode the fields that are read
+var rows = addon.createObjects(columns, { lazy: true });
+console.log(rows.length+' '+rows.at(0).msg); // '2 hello'
@@ -0,0 +1,43 @@
+// Objects per second made by addon(msg), which adds `msg` to an
+// empty object, by a template's factory, and from columns.
+var addon = require('bindings')('addon');
+
+var count = Number(process.argv[2]) || 1000000;
+var createRecord = addon.defineTemplate({ msg: 'string', id: 'number' });
+
+function measure(name, create) {
+  var objects = new Array(count);
+  var start = process.hrtime.bigint();
+  for (var i = 0; i < count; i++) {
+    objects[i] = create(i);
+  }
+  var ns = Number(process.hrtime.bigint() - start);
+  console.log(name + ': ' + (count / ns * 1e3).toFixed(2) + ' M objects/s');
+}
+
+var ids = new Int32Array(count);
+var words = ['hello', 'world'];
+var msgs = new Array(count);
+for (var i = 0; i < count; i++) {
+  ids[i] = i;
+  msgs[i] = words[i % 2];
+}
+
+function measureColumns(name, options, read) {
+  var start = process.hrtime.bigint();
+  var rows = addon.createObjects({ msg: msgs, id: ids }, options);
+  read(rows);
+  var ns = Number(process.hrtime.bigint() - start);
+  console.log(name + ': ' + (count / ns * 1e3).toFixed(2) + ' M objects/s');
+}
+
+for (var round = 0; round < 2; round++) {
+  measure('addon(msg)', function(i) { return addon('hello'); });
+  measure('createRecord(msg, id)', function(i) { return createRecord('hello', i); });
+  measureColumns('createObjects(columns)', undefined, function(rows) {});
+  // reading one field of one row in 100
+  measureColumns('createObjects(columns, { lazy: true })', { lazy: true },
+                 function(rows) {
+                   for (var i = 0; i < rows.length; i += 100) rows.at(i).id;
+                 });
+}
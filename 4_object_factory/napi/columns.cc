@@ -0,0 +1,565 @@
+#include "columns.h"
+#include <assert.h>
+#include <stdio.h>
+#include <stdint.h>
+#include "object_template.h"
+
+napi_status Columns::Init(napi_env env, napi_value exports) {
+  napi_status status;
+
+  napi_value create;
+  status = napi_create_function(
+      env, "createObjects", NAPI_AUTO_LENGTH, CreateObjects, nullptr, &create);
+  if (status != napi_ok) return status;
+
+  return napi_set_named_property(env, exports, "createObjects", create);
+}
+
+Columns::~Columns() {}
+
+void Columns::Destructor(napi_env env, void* nativeObject, void* /*finalize_hint*/) {
+  Columns* obj = static_cast<Columns*>(nativeObject);
+  for (size_t i = 0; i < obj->columns_.size(); i++) {
+    napi_delete_reference(env, obj->columns_[i].value);
+  }
+  napi_delete_reference(env, obj->prototype_);
+  delete obj;
+}
+
+// The rows object and its views are tagged with these, so At() and
+// the getters can tell them from any other wrapped object.
+static const napi_type_tag kRowsTag = {
+  0x636f6c756d6e735fULL, 0x726f77735f746167ULL
+};
+static const napi_type_tag kRowTag = {
+  0x636f6c756d6e735fULL, 0x726f775f5f746167ULL
+};
+
+static void ThrowColumnError(napi_env env, const char* name, const char* what) {
+  char message[128];
+  snprintf(message, sizeof(message), "column '%.40s' %s", name, what);
+  napi_throw_type_error(env, nullptr, message);
+}
+
+bool Columns::GetColumnData(napi_env env,
+                            const char* name,
+                            napi_value value,
+                            bool check_offsets,
+                            ColumnData* data,
+                            size_t* rows) {
+  napi_status status;
+
+  bool is_typedarray;
+  status = napi_is_typedarray(env, value, &is_typedarray);
+  assert(status == napi_ok);
+  if (is_typedarray) {
+    void* values;
+    status = napi_get_typedarray_info(
+        env, value, &data->type, rows, &values, nullptr, nullptr);
+    assert(status == napi_ok);
+    data->kind = kTypedArray;
+    data->data = values;
+    data->array = value;
+    return true;
+  }
+
+  bool is_array;
+  status = napi_is_array(env, value, &is_array);
+  assert(status == napi_ok);
+  if (is_array) {
+    uint32_t length;
+    status = napi_get_array_length(env, value, &length);
+    assert(status == napi_ok);
+    data->kind = kArray;
+    data->array = value;
+    *rows = length;
+    return true;
+  }
+
+  napi_valuetype valuetype;
+  status = napi_typeof(env, value, &valuetype);
+  assert(status == napi_ok);
+  if (valuetype != napi_object) {
+    ThrowColumnError(env, name, "must be a typed array, an Array or strings");
+    return false;
+  }
+
+  napi_value bytes;
+  napi_value offsets;
+  if (napi_get_named_property(env, value, "data", &bytes) != napi_ok ||
+      napi_get_named_property(env, value, "offsets", &offsets) != napi_ok) {
+    return false;
+  }
+
+  bool is_bytes;
+  bool is_offsets;
+  status = napi_is_typedarray(env, bytes, &is_bytes);
+  assert(status == napi_ok);
+  status = napi_is_typedarray(env, offsets, &is_offsets);
+  assert(status == napi_ok);
+
+  napi_typedarray_type bytes_type = napi_int8_array;
+  napi_typedarray_type offsets_type = napi_int8_array;
+  size_t size = 0;
+  size_t count = 0;
+  void* bytes_data = nullptr;
+  void* offsets_data = nullptr;
+  if (is_bytes) {
+    status = napi_get_typedarray_info(
+        env, bytes, &bytes_type, &size, &bytes_data, nullptr, nullptr);
+    assert(status == napi_ok);
+  }
+  if (is_offsets) {
+    status = napi_get_typedarray_info(
+        env, offsets, &offsets_type, &count, &offsets_data, nullptr, nullptr);
+    assert(status == napi_ok);
+  }
+
+  if (bytes_type != napi_uint8_array || offsets_type != napi_uint32_array ||
+      count < 1) {
+    ThrowColumnError(env, name,
+                     "of strings must have a Uint8Array `data` and a "
+                     "Uint32Array `offsets`");
+    return false;
+  }
+
+  const uint32_t* starts = static_cast<const uint32_t*>(offsets_data);
+  if (check_offsets) {
+    for (size_t i = 0; i + 1 < count; i++) {
+      if (starts[i] > starts[i + 1]) {
+        ThrowColumnError(env, name, "has decreasing offsets");
+        return false;
+      }
+    }
+    if (starts[count - 1] > size) {
+      ThrowColumnError(env, name, "has offsets past the end of its data");
+      return false;
+    }
+  }
+
+  data->kind = kStrings;
+  data->data = bytes_data;
+  data->offsets = starts;
+  data->size = size;
+  data->array = bytes;
+  data->offsets_array = offsets;
+  *rows = count - 1;
+  return true;
+}
+
+bool Columns::ReloadColumnData(napi_env env,
+                               const char* name,
+                               size_t rows,
+                               ColumnData* data) {
+  napi_status status;
+
+  void* values;
+  size_t length = 0;
+  switch (data->kind) {
+    case kArray:
+      // read through napi_get_element(), which always sees it as it is
+      return true;
+
+    case kTypedArray:
+      status = napi_get_typedarray_info(
+          env, data->array, nullptr, &length, &values, nullptr, nullptr);
+      assert(status == napi_ok);
+      data->data = values;
+      break;
+
+    case kStrings: {
+      // ReadValue() checks each row's offsets against this size
+      status = napi_get_typedarray_info(
+          env, data->array, nullptr, &data->size, &values, nullptr, nullptr);
+      assert(status == napi_ok);
+      data->data = values;
+
+      size_t count;
+      status = napi_get_typedarray_info(
+          env, data->offsets_array, nullptr, &count, &values, nullptr, nullptr);
+      assert(status == napi_ok);
+      data->offsets = static_cast<const uint32_t*>(values);
+      length = count > 0 ? count - 1 : 0;
+      break;
+    }
+  }
+
+  if (length < rows) {
+    ThrowColumnError(env, name, "no longer has this row");
+    return false;
+  }
+  return true;
+}
+
+napi_status Columns::ReadValue(napi_env env,
+                               const ColumnData& column,
+                               size_t row,
+                               napi_value* result) {
+  switch (column.kind) {
+    case kArray:
+      return napi_get_element(env, column.array, static_cast<uint32_t>(row), result);
+
+    case kStrings: {
+      uint32_t start = column.offsets[row];
+      uint32_t end = column.offsets[row + 1];
+      if (start > end || end > column.size) return napi_invalid_arg;
+      // the data of an empty Uint8Array may be NULL
+      const char* bytes = static_cast<const char*>(column.data);
+      return napi_create_string_utf8(
+          env, start < end ? bytes + start : "", end - start, result);
+    }
+
+    case kTypedArray:
+      break;
+  }
+
+  const void* data = column.data;
+  switch (column.type) {
+    case napi_int8_array:
+      return napi_create_int32(env, static_cast<const int8_t*>(data)[row], result);
+    case napi_uint8_array:
+    case napi_uint8_clamped_array:
+      return napi_create_uint32(env, static_cast<const uint8_t*>(data)[row], result);
+    case napi_int16_array:
+      return napi_create_int32(env, static_cast<const int16_t*>(data)[row], result);
+    case napi_uint16_array:
+      return napi_create_uint32(env, static_cast<const uint16_t*>(data)[row], result);
+    case napi_int32_array:
+      return napi_create_int32(env, static_cast<const int32_t*>(data)[row], result);
+    case napi_uint32_array:
+      return napi_create_uint32(env, static_cast<const uint32_t*>(data)[row], result);
+    case napi_float32_array:
+      return napi_create_double(env, static_cast<const float*>(data)[row], result);
+    case napi_float64_array:
+      return napi_create_double(env, static_cast<const double*>(data)[row], result);
+    case napi_bigint64_array:
+      return napi_create_bigint_int64(
+          env, static_cast<const int64_t*>(data)[row], result);
+    case napi_biguint64_array:
+      return napi_create_bigint_uint64(
+          env, static_cast<const uint64_t*>(data)[row], result);
+  }
+
+  return napi_invalid_arg;
+}
+
+// All rows as plain objects of one shape, in one array.
+napi_value Columns::Materialize(napi_env env,
+                                const std::vector<std::string>& names,
+                                std::vector<ColumnData>& columns,
+                                size_t length) {
+  napi_status status;
+
+  ObjectTemplate tmpl(names);
+  std::vector<napi_value> values(columns.size());
+
+  // filled in order rather than preallocated, so that it keeps fast
+  // elements however many rows there are
+  napi_value result;
+  status = napi_create_array(env, &result);
+  assert(status == napi_ok);
+
+  // Each row leaves handles behind in the current scope; close them
+  // every so often instead of keeping a million of them open.
+  const size_t kPerScope = 1024;
+
+  for (size_t first = 0; first < length; first += kPerScope) {
+    size_t last = first + kPerScope < length ? first + kPerScope : length;
+
+    napi_handle_scope scope;
+    status = napi_open_handle_scope(env, &scope);
+    assert(status == napi_ok);
+
+    for (size_t row = first; row < last; row++) {
+      // Reading an Array element, or setting one of `result`, can run
+      // JS which detaches or shrinks the other columns. So the Arrays
+      // are read first, and the others reloaded before they are read.
+      for (size_t i = 0; i < columns.size() && status == napi_ok; i++) {
+        if (columns[i].kind == kArray) {
+          status = ReadValue(env, columns[i], row, &values[i]);
+        }
+      }
+      for (size_t i = 0; i < columns.size() && status == napi_ok; i++) {
+        if (columns[i].kind == kArray) continue;
+        if (!ReloadColumnData(env, names[i].c_str(), row + 1, &columns[i])) {
+          status = napi_pending_exception;
+        } else {
+          status = ReadValue(env, columns[i], row, &values[i]);
+        }
+      }
+
+      napi_value obj;
+      if (status == napi_ok) status = tmpl.NewObject(env, values.data(), &obj);
+      if (status == napi_ok) {
+        status = napi_set_element(env, result, static_cast<uint32_t>(row), obj);
+      }
+      if (status != napi_ok) break;
+    }
+
+    napi_close_handle_scope(env, scope);
+    if (status != napi_ok) {
+      bool pending;
+      napi_is_exception_pending(env, &pending);
+      if (!pending) napi_throw_error(env, nullptr, "could not create objects");
+      return nullptr;
+    }
+  }
+
+  return result;
+}
+
+#define DECLARE_NAPI_METHOD(name, func)                          \
+  { name, 0, func, 0, 0, 0, napi_default, 0 }
+
+// createObjects(columns[, { lazy }]) makes one object per row.
+napi_value Columns::CreateObjects(napi_env env, napi_callback_info info) {
+  napi_status status;
+
+  size_t argc = 2;
+  napi_value args[2];
+  status = napi_get_cb_info(env, info, &argc, args, nullptr, nullptr);
+  assert(status == napi_ok);
+
+  napi_valuetype valuetype;
+  status = napi_typeof(env, args[0], &valuetype);
+  assert(status == napi_ok);
+  if (valuetype != napi_object) {
+    napi_throw_type_error(env, nullptr, "columns must be an object");
+    return nullptr;
+  }
+
+  bool lazy = false;
+  status = napi_typeof(env, args[1], &valuetype);
+  assert(status == napi_ok);
+  if (valuetype == napi_object) {
+    napi_value option;
+    status = napi_get_named_property(env, args[1], "lazy", &option);
+    if (status != napi_ok) return nullptr;
+    status = napi_coerce_to_bool(env, option, &option);
+    if (status != napi_ok) return nullptr;
+    status = napi_get_value_bool(env, option, &lazy);
+    assert(status == napi_ok);
+  }
+
+  napi_value names;
+  status = napi_get_property_names(env, args[0], &names);
+  if (status != napi_ok) return nullptr;
+
+  uint32_t count;
+  status = napi_get_array_length(env, names, &count);
+  assert(status == napi_ok);
+
+  std::vector<std::string> column_names(count);
+  std::vector<napi_value> column_values(count);
+  std::vector<ColumnData> columns(count);
+  size_t length = 0;
+  for (uint32_t i = 0; i < count; i++) {
+    napi_value name;
+    status = napi_get_element(env, names, i, &name);
+    assert(status == napi_ok);
+
+    size_t size;
+    status = napi_get_value_string_utf8(env, name, nullptr, 0, &size);
+    assert(status == napi_ok);
+    column_names[i].resize(size);
+    status = napi_get_value_string_utf8(
+        env, name, &column_names[i][0], size + 1, nullptr);
+    assert(status == napi_ok);
+
+    status = napi_get_property(env, args[0], name, &column_values[i]);
+    if (status != napi_ok) return nullptr;
+
+    size_t rows;
+    if (!GetColumnData(env, column_names[i].c_str(), column_values[i], true,
+                       &columns[i], &rows)) {
+      return nullptr;
+    }
+
+    if (i > 0 && rows != length) {
+      napi_throw_range_error(
+          env, nullptr, "columns must all have the same number of rows");
+      return nullptr;
+    }
+    length = rows;
+  }
+
+  if (!lazy) return Materialize(env, column_names, columns, length);
+
+  Columns* obj = new Columns();
+  obj->length_ = length;
+
+  // The views of all rows share a prototype with one getter per
+  // column. It is a plain object rather than a class, as V8 keeps
+  // every class it is given for as long as the process runs.
+  napi_value prototype;
+  status = napi_create_object(env, &prototype);
+  assert(status == napi_ok);
+
+  status = napi_create_reference(env, prototype, 0, &obj->prototype_);
+  assert(status == napi_ok);
+
+  // the getters' data points into columns_, which must not move
+  obj->columns_.resize(count);
+  std::vector<napi_property_descriptor> fields(count);
+  for (uint32_t i = 0; i < count; i++) {
+    obj->columns_[i].name = column_names[i];
+    status = napi_create_reference(env, column_values[i], 1, &obj->columns_[i].value);
+    assert(status == napi_ok);
+
+    napi_property_descriptor field = {
+        obj->columns_[i].name.c_str(), 0, 0, RowGetField, 0, 0,
+        napi_enumerable, &obj->columns_[i] };
+    fields[i] = field;
+  }
+
+  status = napi_define_properties(env, prototype, fields.size(), fields.data());
+  assert(status == napi_ok);
+
+  napi_value rows;
+  status = napi_create_object(env, &rows);
+  assert(status == napi_ok);
+
+  napi_value length_value;
+  status = napi_create_double(env, static_cast<double>(length), &length_value);
+  assert(status == napi_ok);
+
+  napi_property_descriptor properties[] = {
+      { "length", 0, 0, 0, 0, length_value, napi_enumerable, 0 },
+      DECLARE_NAPI_METHOD("at", At),
+      { "rowPrototype", 0, 0, 0, 0, prototype, napi_default, 0 },
+  };
+  status = napi_define_properties(
+      env, rows, sizeof(properties) / sizeof(*properties), properties);
+  assert(status == napi_ok);
+
+  status = napi_wrap(env,
+                     rows,
+                     reinterpret_cast<void*>(obj),
+                     Columns::Destructor,
+                     nullptr,  // finalize_hint
+                     nullptr);
+  assert(status == napi_ok);
+
+  status = napi_type_tag_object(env, rows, &kRowsTag);
+  assert(status == napi_ok);
+
+  // Row views keep the rows object alive through their prototype. Its
+  // key is a symbol, which no column name can be.
+  napi_value owner_key;
+  status = napi_create_symbol(env, nullptr, &owner_key);
+  assert(status == napi_ok);
+
+  napi_property_descriptor owner[] = {
+      { nullptr, owner_key, 0, 0, 0, rows, napi_default, 0 },
+  };
+  status = napi_define_properties(env, prototype, 1, owner);
+  assert(status == napi_ok);
+
+  return rows;
+}
+
+// rows.at(i) is a view of row i, or undefined past the last row.
+napi_value Columns::At(napi_env env, napi_callback_info info) {
+  napi_status status;
+
+  size_t argc = 1;
+  napi_value args[1];
+  napi_value jsthis;
+  status = napi_get_cb_info(env, info, &argc, args, &jsthis, nullptr);
+  assert(status == napi_ok);
+
+  bool is_rows;
+  status = napi_check_object_type_tag(env, jsthis, &kRowsTag, &is_rows);
+  if (status != napi_ok || !is_rows) {
+    napi_throw_type_error(env, nullptr, "expected a rows object");
+    return nullptr;
+  }
+
+  Columns* obj;
+  status = napi_unwrap(env, jsthis, reinterpret_cast<void**>(&obj));
+  assert(status == napi_ok);
+
+  double index;
+  status = napi_get_value_double(env, args[0], &index);
+  if (status != napi_ok) {
+    napi_throw_type_error(env, nullptr, "expected a number");
+    return nullptr;
+  }
+  if (!(index >= 0 && index < obj->length_)) return nullptr;
+
+  // N-API cannot set a prototype, but Object.create() can
+  napi_value global, object, create, prototype;
+  status = napi_get_global(env, &global);
+  assert(status == napi_ok);
+  status = napi_get_named_property(env, global, "Object", &object);
+  if (status != napi_ok) return nullptr;
+  status = napi_get_named_property(env, object, "create", &create);
+  if (status != napi_ok) return nullptr;
+  status = napi_get_reference_value(env, obj->prototype_, &prototype);
+  assert(status == napi_ok);
+
+  napi_value view;
+  status = napi_call_function(env, object, create, 1, &prototype, &view);
+  if (status != napi_ok) return nullptr;
+
+  // The row number itself stands in for the native object, so views
+  // need no allocation of their own and no finalizer.
+  size_t row = static_cast<size_t>(index);
+  status = napi_wrap(env,
+                     view,
+                     reinterpret_cast<void*>(row + 1),
+                     nullptr,  // finalize_cb
+                     nullptr,  // finalize_hint
+                     nullptr);
+  assert(status == napi_ok);
+
+  status = napi_type_tag_object(env, view, &kRowTag);
+  assert(status == napi_ok);
+
+  return view;
+}
+
+napi_value Columns::RowGetField(napi_env env, napi_callback_info info) {
+  napi_status status;
+
+  napi_value jsthis;
+  void* data;
+  status = napi_get_cb_info(env, info, nullptr, nullptr, &jsthis, &data);
+  assert(status == napi_ok);
+  const Column* column = static_cast<const Column*>(data);
+
+  bool is_row;
+  status = napi_check_object_type_tag(env, jsthis, &kRowTag, &is_row);
+  if (status != napi_ok || !is_row) {
+    napi_throw_type_error(env, nullptr, "expected a row");
+    return nullptr;
+  }
+
+  void* wrapped;
+  status = napi_unwrap(env, jsthis, &wrapped);
+  assert(status == napi_ok);
+  size_t row = reinterpret_cast<uintptr_t>(wrapped) - 1;
+
+  // the column may have changed, or its buffer been detached, since
+  // createObjects() looked at it
+  napi_value value;
+  status = napi_get_reference_value(env, column->value, &value);
+  assert(status == napi_ok);
+
+  ColumnData column_data;
+  size_t rows;
+  if (!GetColumnData(env, column->name.c_str(), value, false, &column_data, &rows)) {
+    return nullptr;
+  }
+
+  napi_value result;
+  if (row >= rows ||
+      ReadValue(env, column_data, row, &result) != napi_ok) {
+    bool pending;
+    napi_is_exception_pending(env, &pending);
+    if (!pending) ThrowColumnError(env, column->name.c_str(), "no longer has this row");
+    return nullptr;
+  }
+
+  return result;
+}
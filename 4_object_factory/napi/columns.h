@@ -0,0 +1,91 @@
+#ifndef TEST_ADDONS_NAPI_4_OBJECT_FACTORY_COLUMNS_H_
+#define TEST_ADDONS_NAPI_4_OBJECT_FACTORY_COLUMNS_H_
+
+#include <node_api.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+/*
+Many objects from columnar data in one call:
+
+  addon.createObjects({
+    id: new Int32Array([1, 2]),
+    msg: { data: utf8Bytes, offsets: new Uint32Array([0, 5, 10]) },
+  });  // [ { id: 1, msg: 'hello' }, { id: 2, msg: 'world' } ]
+
+A column is a typed array, a plain Array, or a string column: the
+UTF-8 bytes of all its strings back to back in the Uint8Array `data`,
+with string i running from offsets[i] to offsets[i + 1]. All columns
+must have the same number of rows.
+
+With { lazy: true } nothing is decoded up front. The result is a
+`rows` object with `length` and `at(i)`, which returns a view of row
+i whose fields are decoded from the columns when read. The fields
+are getters on the views' shared prototype, so spreading or
+JSON.stringify() of a view sees none of them. The columns are kept,
+not copied, so later changes to them show in the views.
+*/
+class Columns {
+ public:
+  static napi_status Init(napi_env env, napi_value exports);
+
+ private:
+  enum Kind { kTypedArray, kStrings, kArray };
+
+  struct Column {
+    std::string name;
+    napi_ref value;  // as passed in, and looked at again on every read
+  };
+
+  // Where the rows of one column are right now.
+  struct ColumnData {
+    Kind kind;
+    napi_typedarray_type type;
+    const void* data;
+    const uint32_t* offsets;
+    size_t size;  // of `data` in bytes, for string columns
+    napi_value array;  // the column, or the `data` of a string column
+    napi_value offsets_array;  // for string columns
+  };
+
+  Columns() : length_(0), prototype_(nullptr) {}
+  ~Columns();
+
+  static napi_value CreateObjects(napi_env env, napi_callback_info info);
+  static napi_value At(napi_env env, napi_callback_info info);
+  static napi_value RowGetField(napi_env env, napi_callback_info info);
+  static void Destructor(napi_env env, void* nativeObject, void* finalize_hint);
+
+  // Checks `value` to be a column and describes it in `*data`,
+  // setting `*rows` to its number of rows; false after throwing.
+  // Only with `check_offsets` are all string offsets checked.
+  static bool GetColumnData(napi_env env,
+                            const char* name,
+                            napi_value value,
+                            bool check_offsets,
+                            ColumnData* data,
+                            size_t* rows);
+  // Points `data` at where its typed arrays keep their rows now, as JS
+  // run since GetColumnData() may have moved or detached them. Runs no
+  // JS itself; false after throwing if fewer than `rows` are left.
+  static bool ReloadColumnData(napi_env env,
+                               const char* name,
+                               size_t rows,
+                               ColumnData* data);
+  static napi_status ReadValue(napi_env env,
+                               const ColumnData& column,
+                               size_t row,
+                               napi_value* result);
+  static napi_value Materialize(napi_env env,
+                                const std::vector<std::string>& names,
+                                std::vector<ColumnData>& columns,
+                                size_t length);
+
+  std::vector<Column> columns_;
+  size_t length_;
+  napi_ref prototype_;  // weak, as the rows object holds it too
+};
+
+#endif  // TEST_ADDONS_NAPI_4_OBJECT_FACTORY_COLUMNS_H_
@@ -0,0 +1,211 @@
+#include "object_template.h"
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+
+// Like a property made by assignment, so objects match plain ones.
+static const napi_property_attributes kPlainProperty =
+    static_cast<napi_property_attributes>(napi_writable | napi_enumerable |
+                                          napi_configurable);
+
+static const struct {
+  const char* name;
+  napi_valuetype type;
+} kTypes[] = {
+    { "string", napi_string },
+    { "number", napi_number },
+    { "boolean", napi_boolean },
+    { "object", napi_object },
+    { "any", napi_undefined },
+};
+
+napi_status ObjectTemplate::Init(napi_env env, napi_value exports) {
+  napi_status status;
+
+  napi_value define;
+  status = napi_create_function(
+      env, "defineTemplate", NAPI_AUTO_LENGTH, Define, nullptr, &define);
+  if (status != napi_ok) return status;
+
+  return napi_set_named_property(env, exports, "defineTemplate", define);
+}
+
+ObjectTemplate::ObjectTemplate(const std::vector<std::string>& names)
+    : names_(names), types_(names.size(), napi_undefined) {
+  BuildDescriptors();
+}
+
+void ObjectTemplate::BuildDescriptors() {
+  descriptors_.clear();
+  for (size_t i = 0; i < names_.size(); i++) {
+    napi_property_descriptor descriptor = {
+        names_[i].c_str(), 0, 0, 0, 0, 0, kPlainProperty, 0 };
+    descriptors_.push_back(descriptor);
+  }
+}
+
+void ObjectTemplate::Destructor(napi_env env, void* nativeObject, void* /*finalize_hint*/) {
+  delete static_cast<ObjectTemplate*>(nativeObject);
+}
+
+// defineTemplate(layout) returns a function making objects with the
+// properties of `layout`, in its order, from its positional arguments.
+napi_value ObjectTemplate::Define(napi_env env, napi_callback_info info) {
+  napi_status status;
+
+  size_t argc = 1;
+  napi_value args[1];
+  status = napi_get_cb_info(env, info, &argc, args, nullptr, nullptr);
+  assert(status == napi_ok);
+
+  napi_valuetype valuetype;
+  status = napi_typeof(env, args[0], &valuetype);
+  assert(status == napi_ok);
+  if (valuetype != napi_object) {
+    napi_throw_type_error(env, nullptr, "layout must be an object");
+    return nullptr;
+  }
+
+  napi_value names;
+  status = napi_get_property_names(env, args[0], &names);
+  if (status != napi_ok) return nullptr;
+
+  uint32_t count;
+  status = napi_get_array_length(env, names, &count);
+  assert(status == napi_ok);
+
+  ObjectTemplate* tmpl = new ObjectTemplate();
+  for (uint32_t i = 0; i < count; i++) {
+    napi_value name;
+    status = napi_get_element(env, names, i, &name);
+    assert(status == napi_ok);
+
+    napi_value type;
+    status = napi_get_property(env, args[0], name, &type);
+    if (status != napi_ok) {
+      delete tmpl;
+      return nullptr;
+    }
+
+    size_t length;
+    status = napi_get_value_string_utf8(env, name, nullptr, 0, &length);
+    assert(status == napi_ok);
+    std::string utf8(length, '\0');
+    status = napi_get_value_string_utf8(env, name, &utf8[0], length + 1, nullptr);
+    assert(status == napi_ok);
+
+    char type_name[16] = "";
+    napi_get_value_string_utf8(env, type, type_name, sizeof(type_name), nullptr);
+
+    size_t t = 0;
+    while (t < sizeof(kTypes) / sizeof(*kTypes) &&
+           strcmp(type_name, kTypes[t].name) != 0) {
+      t++;
+    }
+    if (t == sizeof(kTypes) / sizeof(*kTypes)) {
+      delete tmpl;
+      char message[128];
+      snprintf(message, sizeof(message),
+               "type of '%.40s' must be 'string', 'number', 'boolean', "
+               "'object' or 'any'", utf8.c_str());
+      napi_throw_type_error(env, nullptr, message);
+      return nullptr;
+    }
+
+    tmpl->names_.push_back(utf8);
+    tmpl->types_.push_back(kTypes[t].type);
+  }
+
+  tmpl->BuildDescriptors();
+
+  napi_value create;
+  status = napi_create_function(
+      env, "createFromTemplate", NAPI_AUTO_LENGTH, Create, tmpl, &create);
+  assert(status == napi_ok);
+
+  status = napi_add_finalizer(
+      env, create, tmpl, ObjectTemplate::Destructor, nullptr, nullptr);
+  assert(status == napi_ok);
+
+  return create;
+}
+
+bool ObjectTemplate::CheckField(napi_env env, size_t i, napi_value value) const {
+  if (types_[i] == napi_undefined) return true;
+
+  napi_valuetype valuetype;
+  napi_status status = napi_typeof(env, value, &valuetype);
+  assert(status == napi_ok);
+
+  // null would change an object field's representation as little
+  // as any other object, and marks a missing one
+  if (valuetype == types_[i] ||
+      (types_[i] == napi_object && valuetype == napi_null)) {
+    return true;
+  }
+
+  char message[96];
+  snprintf(message, sizeof(message), "'%.40s' must be of the template's type",
+           names_[i].c_str());
+  napi_throw_type_error(env, nullptr, message);
+  return false;
+}
+
+napi_status ObjectTemplate::NewObject(napi_env env,
+                                      const napi_value* values,
+                                      napi_value* result) const {
+  napi_status status = napi_create_object(env, result);
+  if (status != napi_ok) return status;
+
+  // a few on the stack cover most records
+  const size_t kOnStack = 16;
+  napi_property_descriptor on_stack[kOnStack];
+  std::vector<napi_property_descriptor> on_heap;
+  napi_property_descriptor* descriptors = on_stack;
+  if (descriptors_.size() > kOnStack) {
+    on_heap.resize(descriptors_.size());
+    descriptors = on_heap.data();
+  }
+
+  for (size_t i = 0; i < descriptors_.size(); i++) {
+    descriptors[i] = descriptors_[i];
+    descriptors[i].value = values[i];
+  }
+
+  return napi_define_properties(env, *result, descriptors_.size(), descriptors);
+}
+
+napi_value ObjectTemplate::Create(napi_env env, napi_callback_info info) {
+  napi_status status;
+
+  // missing arguments come back as undefined; a few on the stack
+  // cover most records, and larger ones take a second look
+  const size_t kOnStack = 16;
+  napi_value on_stack[kOnStack];
+  size_t argc = kOnStack;
+  void* data;
+  status = napi_get_cb_info(env, info, &argc, on_stack, nullptr, &data);
+  assert(status == napi_ok);
+  ObjectTemplate* tmpl = static_cast<ObjectTemplate*>(data);
+
+  size_t count = tmpl->FieldCount();
+  napi_value* args = on_stack;
+  std::vector<napi_value> on_heap;
+  if (count > kOnStack) {
+    on_heap.resize(count);
+    args = on_heap.data();
+    argc = count;
+    status = napi_get_cb_info(env, info, &argc, args, nullptr, nullptr);
+    assert(status == napi_ok);
+  }
+
+  for (size_t i = 0; i < count; i++) {
+    if (!tmpl->CheckField(env, i, args[i])) return nullptr;
+  }
+
+  napi_value obj;
+  status = tmpl->NewObject(env, args, &obj);
+  assert(status == napi_ok);
+
+  return obj;
+}
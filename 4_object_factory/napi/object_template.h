@@ -0,0 +1,57 @@
+#ifndef TEST_ADDONS_NAPI_4_OBJECT_FACTORY_OBJECT_TEMPLATE_H_
+#define TEST_ADDONS_NAPI_4_OBJECT_FACTORY_OBJECT_TEMPLATE_H_
+
+#include <node_api.h>
+#include <stddef.h>
+#include <string>
+#include <vector>
+
+/*
+A property layout declared once, for factories that make many objects
+of the same kind:
+
+  var createRecord = addon.defineTemplate({ msg: 'string', id: 'number' });
+  createRecord('hello', 1);  // { msg: 'hello', id: 1 }
+
+Every object gets the same properties in the same order, each holding
+the declared type ('string', 'number', 'boolean', 'object' or 'any'),
+so all of them share one hidden class and field representation. The
+properties are defined in a single napi_define_properties() call from
+descriptors built once per template.
+*/
+class ObjectTemplate {
+ public:
+  static napi_status Init(napi_env env, napi_value exports);
+
+  // A layout of `names`, each field of any type.
+  explicit ObjectTemplate(const std::vector<std::string>& names);
+
+  size_t FieldCount() const { return names_.size(); }
+  const char* FieldName(size_t i) const { return names_[i].c_str(); }
+
+  // A new object holding values[0..FieldCount()), which must have
+  // been checked to be of the declared types already.
+  napi_status NewObject(napi_env env, const napi_value* values, napi_value* result) const;
+  // Whether `value` is of the type declared for field `i`; false
+  // after throwing a TypeError if not.
+  bool CheckField(napi_env env, size_t i, napi_value value) const;
+
+ private:
+  ObjectTemplate() {}
+  // the descriptors point into names_, so copies would dangle
+  ObjectTemplate(const ObjectTemplate&) = delete;
+  ObjectTemplate& operator=(const ObjectTemplate&) = delete;
+
+  // Called once names_ is complete, as the descriptors point into it.
+  void BuildDescriptors();
+
+  static napi_value Define(napi_env env, napi_callback_info info);
+  static napi_value Create(napi_env env, napi_callback_info info);
+  static void Destructor(napi_env env, void* nativeObject, void* finalize_hint);
+
+  std::vector<std::string> names_;
+  std::vector<napi_valuetype> types_;  // napi_undefined for 'any'
+  std::vector<napi_property_descriptor> descriptors_;
+};
+
+#endif  // TEST_ADDONS_NAPI_4_OBJECT_FACTORY_OBJECT_TEMPLATE_H_
@@ -1,7 +1,38 @@
 #include "myobject.h"
+#include "myobjectarray.h"
+#include <assert.h>
+
+// inspect() returns the live-object counters of each wrapped class.
+napi_value Inspect(napi_env env, napi_callback_info info) {
+  napi_status status;
+
+  napi_value result;
+  status = napi_create_object(env, &result);
+  assert(status == napi_ok);
+
+  napi_value stats;
+  status = MyObject::Stats(env, &stats);
+  assert(status == napi_ok);
+
+  status = napi_set_named_property(env, result, "MyObject", stats);
+  assert(status == napi_ok);
+
+  return result;
+}
 
 napi_value Init(napi_env env, napi_value exports) {
-  return MyObject::Init(env, exports);
+  napi_status status;
+
+  napi_value inspect;
+  status = napi_create_function(
+      env, "inspect", NAPI_AUTO_LENGTH, Inspect, nullptr, &inspect);
+  assert(status == napi_ok);
+
+  status = napi_set_named_property(env, exports, "inspect", inspect);
+  assert(status == napi_ok);
+
+  MyObject::Init(env, exports);
+  return MyObjectArray::Init(env, exports);
 }
 
 NAPI_MODULE(NODE_GYP_MODULE_NAME, Init)
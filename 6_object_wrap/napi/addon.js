@@ -11,3 +11,49 @@ console.log( obj.multiply(10).value ); // 130
 var newobj = obj.multiply(-1);
 console.log( newobj.value ); // -13
 console.log( obj === newobj ); // false
+
+// results can go into an existing object instead of a new one
+console.log( obj.multiply(2, newobj) === newobj ); // true
+console.log( newobj.value ); // 26
+
+// or change the object itself, without allocating anything
+console.log( newobj.multiplyInPlace(2).addInPlace(-2).value ); // 50
+
+// a whole sequence of ops in one call: +1, *2, +5
+var ops = new Uint8Array([addon.MyObject.OP_PLUS_ONE,
+                          addon.MyObject.OP_MULTIPLY,
+                          addon.MyObject.OP_ADD]);
+var operands = new Float64Array([2, 5]);
+var steps = new Float64Array(ops.length);
+console.log( obj.apply(ops, operands, steps) ); // 33
+console.log( steps ); // Float64Array [ 14, 28, 33 ]
+
+// many values in one buffer, changed with one call per bulk op
+var array = new addon.MyObjectArray(new Float64Array([1, 2, 3, 4]));
+console.log( array.plusOne().multiply(2).sum() ); // 28
+console.log( array.values ); // Float64Array [ 4, 6, 8, 10 ]
+console.log( array.map(ops, operands).values ); // Float64Array [ 15, 19, 23, 27 ]
+
+// at(i) is a handle onto one slot, not a copy of it
+var third = array.at(2);
+third.value = 100;
+console.log( array.values[2] ); // 100
+
+// objects passed in are checked to really be MyObjects
+try {
+  obj.multiply(2, { value: 0 });
+} catch (e) {
+  console.log( e.message ); // target must be a MyObject
+}
+
+// free the native side now instead of waiting for the GC
+var temp = new addon.MyObject(1);
+temp.dispose();
+try {
+  temp.plusOne();
+} catch (e) {
+  console.log( e.message ); // MyObject has been disposed or transferred
+}
+
+// native memory held by wrapped objects, summed over all threads
+console.log( addon.inspect().MyObject.live ); // instances not yet finalized
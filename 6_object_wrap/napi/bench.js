@@ -0,0 +1,85 @@
+// Construct/finalize throughput of MyObject with and without the
+// per-instance wrapper reference, and method call throughput with
+// and without the type tag check. Run with `node --expose-gc`.
+var bindings = require('bindings');
+
+var count = Number(process.argv[2]) || 1000000;
+var rounds = 5;
+
+function nextTick() {
+  // finalizers run after GC, on a later turn of the event loop
+  return new Promise(function(resolve) { setImmediate(resolve); });
+}
+
+async function measure(name) {
+  var MyObject = bindings(name).MyObject;
+  var construct = 0;
+  var finalize = 0;
+
+  for (var r = 0; r < rounds; r++) {
+    var objects = new Array(count);
+    var start = process.hrtime.bigint();
+    for (var i = 0; i < count; i++) {
+      objects[i] = new MyObject(i);
+    }
+    construct += Number(process.hrtime.bigint() - start);
+
+    objects = null;
+    start = process.hrtime.bigint();
+    global.gc();
+    await nextTick();
+    finalize += Number(process.hrtime.bigint() - start);
+  }
+
+  console.log(name + ':');
+  console.log('\tconstruct: ' + (count * rounds / construct * 1e3).toFixed(2) +
+              ' M objects/s');
+  console.log('\tGC + finalize: ' + (count * rounds / finalize * 1e3).toFixed(2) +
+              ' M objects/s');
+}
+
+function measureCalls(name, quiet) {
+  var MyObject = bindings(name).MyObject;
+  var obj = new MyObject(0);
+  var target = new MyObject(0);
+  var plain = 0;
+  var checked = 0;
+
+  for (var r = 0; r < rounds; r++) {
+    var start = process.hrtime.bigint();
+    for (var i = 0; i < count; i++) {
+      obj.plusOne();
+    }
+    plain += Number(process.hrtime.bigint() - start);
+
+    // the target argument is what gets its tag checked
+    start = process.hrtime.bigint();
+    for (var i = 0; i < count; i++) {
+      obj.multiply(1, target);
+    }
+    checked += Number(process.hrtime.bigint() - start);
+  }
+
+  if (quiet) return;
+  console.log(name + ':');
+  console.log('\tplusOne(): ' +
+              (count * rounds / plain * 1e3).toFixed(2) + ' M calls/s');
+  console.log('\tmultiply(k, target): ' +
+              (count * rounds / checked * 1e3).toFixed(2) + ' M calls/s');
+}
+
+if (typeof global.gc !== 'function') {
+  console.log('run with node --expose-gc bench.js');
+  process.exit(1);
+}
+
+measure('addon_with_ref').then(function() {
+  return measure('addon');
+}).then(function() {
+  // a first pass over both builds, so the call sites have seen both
+  // kinds of object before either is timed
+  measureCalls('addon_untagged', true);
+  measureCalls('addon', true);
+  measureCalls('addon_untagged');
+  measureCalls('addon');
+});
@@ -2,7 +2,20 @@
   "targets": [
     {
       "target_name": "addon",
-      "sources": [ "addon.cc", "myobject.cc" ]
+      "sources": [ "addon.cc", "myobject.cc", "myobjectarray.cc" ]
+    },
+    {
+      # the same addon, but each MyObject keeps a napi_ref to its
+      # wrapper; only built for bench.js to compare against
+      "target_name": "addon_with_ref",
+      "sources": [ "addon.cc", "myobject.cc", "myobjectarray.cc" ],
+      "defines": [ "MYOBJECT_WRAPPER_REF" ]
+    },
+    {
+      # and without type tags, to show what checking them costs
+      "target_name": "addon_untagged",
+      "sources": [ "addon.cc", "myobject.cc", "myobjectarray.cc" ],
+      "defines": [ "MYOBJECT_NO_TYPE_TAG" ]
     }
   ]
 }
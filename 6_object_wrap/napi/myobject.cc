@@ -1,41 +1,231 @@
 #include "myobject.h"
 #include <assert.h>
+#include <stdint.h>
+#include <mutex>
+#include <new>
+#include <unordered_map>
+#include <vector>
 
-napi_ref MyObject::constructor;
+thread_local napi_ref MyObject::constructor;
+
+ObjectStats MyObject::stats;
 
 MyObject::MyObject(double value)
-    : value_(value), env_(nullptr), wrapper_(nullptr) {}
+    : value_(value), born_(ObjectStats::Now()), env_(nullptr), wrapper_(nullptr) {}
+
+MyObject::~MyObject() {
+  if (wrapper_ != nullptr) {
+    napi_delete_reference(env_, wrapper_);
+    stats.RefDeleted();
+  }
+}
 
-MyObject::~MyObject() { napi_delete_reference(env_, wrapper_); }
+// A reference from the native object back to its JS wrapper costs
+// a handle-table entry and GC work for every instance, so only
+// take one in builds where native code needs to reach the wrapper.
+#ifdef MYOBJECT_WRAPPER_REF
+static const bool kKeepWrapperRef = true;
+#else
+static const bool kKeepWrapperRef = false;
+#endif
+
+thread_local SlabAllocator<MyObject> MyObject::allocator;
+
+// Every wrapper is tagged with this, so Unwrap() can tell a MyObject
+// passed in as an argument from any other object, including ones
+// wrapped by other addons. MYOBJECT_NO_TYPE_TAG leaves the check
+// out; it is only defined for the build bench.js compares against.
+static const napi_type_tag kMyObjectTag = {
+  0x6f626a5f77726170ULL, 0x9e3779b97f4a7c15ULL
+};
+
+// What using a MyObject after dispose() or transfer() throws.
+static void ThrowDisposed(napi_env env) {
+  napi_throw_error(env, nullptr, "MyObject has been disposed or transferred");
+}
+
+MyObject* MyObject::Unwrap(napi_env env,
+                           napi_value value,
+                           const char* message) {
+  napi_status status;
+
+#ifndef MYOBJECT_NO_TYPE_TAG
+  bool is_myobject;
+  status = napi_check_object_type_tag(env, value, &kMyObjectTag, &is_myobject);
+  if (status != napi_ok || !is_myobject) {
+    napi_throw_type_error(env, nullptr, message);
+    return nullptr;
+  }
+#endif
+
+  MyObject* obj;
+  status = napi_unwrap(env, value, reinterpret_cast<void**>(&obj));
+  if (status != napi_ok) {
+#ifndef MYOBJECT_NO_TYPE_TAG
+    // tagged, so it was a MyObject until dispose()
+    ThrowDisposed(env);
+#else
+    napi_throw_type_error(env, nullptr, message);
+#endif
+    return nullptr;
+  }
+
+  return obj;
+}
+
+// The receiver of a prototype method. napi_define_class() gives
+// methods a receiver signature, so V8 only runs them on objects made
+// by the MyObject constructor, and `this` needs no tag check on the
+// hot path; it is only unwrapped no more once disposed or
+// transferred. Accessors get no such signature and use Unwrap().
+static MyObject* UnwrapThis(napi_env env, napi_value jsthis) {
+  MyObject* obj;
+  napi_status status = napi_unwrap(env, jsthis, reinterpret_cast<void**>(&obj));
+  if (status != napi_ok) {
+    ThrowDisposed(env);
+    return nullptr;
+  }
+  return obj;
+}
 
 void MyObject::Destructor(napi_env env, void* nativeObject, void* /*finalize_hint*/) {
-  reinterpret_cast<MyObject*>(nativeObject)->~MyObject();
+  MyObject* obj = reinterpret_cast<MyObject*>(nativeObject);
+  stats.Finalized(obj->born_);
+  obj->~MyObject();
+  size_t released = allocator.Free(obj);
+  if (released > 0) stats.Released(env, released);
+}
+
+// Env cleanup hook; see SlabAllocator::Close().
+void MyObject::ReleaseSlabs(void* arg) {
+  size_t released = allocator.Close();
+  if (released > 0) stats.Released(static_cast<napi_env>(arg), released);
+}
+
+napi_status MyObject::Stats(napi_env env, napi_value* result) {
+  return stats.ToObject(env, sizeof(MyObject), result);
 }
 
 #define DECLARE_NAPI_METHOD(name, func)                          \
   { name, 0, func, 0, 0, 0, napi_default, 0 }
 
+#define DECLARE_NAPI_STATIC_VALUE(name, value)                   \
+  { name, 0, 0, 0, 0, value, napi_static, 0 }
+
+// Symbol.dispose, so `using` declarations dispose of MyObjects;
+// NULL where the runtime does not define it.
+static napi_value GetDisposeSymbol(napi_env env) {
+  napi_status status;
+
+  napi_value global, symbol, dispose;
+  status = napi_get_global(env, &global);
+  assert(status == napi_ok);
+  status = napi_get_named_property(env, global, "Symbol", &symbol);
+  assert(status == napi_ok);
+  status = napi_get_named_property(env, symbol, "dispose", &dispose);
+  assert(status == napi_ok);
+
+  napi_valuetype valuetype;
+  status = napi_typeof(env, dispose, &valuetype);
+  assert(status == napi_ok);
+
+  return valuetype == napi_symbol ? dispose : nullptr;
+}
+
+static napi_value CreateInt32(napi_env env, int32_t value) {
+  napi_value result;
+  napi_status status = napi_create_int32(env, value, &result);
+  assert(status == napi_ok);
+  return result;
+}
+
+// What transfer() keeps of an object. Its slot goes back to the slab
+// of the thread that made it, and adopt() takes one from its own.
+struct TransferredObject {
+  double value;
+  int64_t born;
+};
+
+/*
+Moving objects between worker_threads: transfer() takes the native
+objects out of their wrappers, which then throw like disposed ones,
+and parks their state in a process-wide table under a numeric token.
+The token is posted to another thread, where adopt() wraps the same
+objects again, in slots of that thread's slab. Like a transferred
+ArrayBuffer, each object is owned by one thread at a time.
+
+Slots go back to their slab when transfer() runs, so a token that is
+never adopted holds none. A number can be copied anywhere, so there
+is no telling when such a token has been dropped; what it holds is
+freed once no thread has the addon loaded any more.
+*/
+static std::mutex transfers_mutex;
+static std::unordered_map<uint64_t, std::vector<TransferredObject> > transfers;
+static uint64_t next_transfer = 1;
+static int loaded_envs = 0;  // guarded by transfers_mutex
+
+void MyObject::ForgetTransfers(void* /*arg*/) {
+  std::lock_guard<std::mutex> lock(transfers_mutex);
+  if (--loaded_envs > 0) return;
+
+  // nobody is left to adopt them
+  std::unordered_map<uint64_t, std::vector<TransferredObject> >::iterator it;
+  for (it = transfers.begin(); it != transfers.end(); ++it) {
+    for (size_t i = 0; i < it->second.size(); i++) {
+      stats.Finalized(it->second[i].born);
+    }
+  }
+  transfers.clear();
+}
+
 napi_value MyObject::Init(napi_env env, napi_value exports) {
   napi_status status;
   napi_property_descriptor properties[] = {
       { "value", 0, 0, GetValue, SetValue, 0, napi_default, 0 },
       DECLARE_NAPI_METHOD("plusOne", PlusOne),
       DECLARE_NAPI_METHOD("multiply", Multiply),
+      DECLARE_NAPI_METHOD("multiplyInPlace", MultiplyInPlace),
+      DECLARE_NAPI_METHOD("addInPlace", AddInPlace),
+      DECLARE_NAPI_METHOD("apply", Apply),
+      DECLARE_NAPI_STATIC_VALUE("OP_PLUS_ONE", CreateInt32(env, kOpPlusOne)),
+      DECLARE_NAPI_STATIC_VALUE("OP_MULTIPLY", CreateInt32(env, kOpMultiply)),
+      DECLARE_NAPI_STATIC_VALUE("OP_ADD", CreateInt32(env, kOpAdd)),
+      DECLARE_NAPI_METHOD("dispose", Dispose),
+      { "transfer", 0, Transfer, 0, 0, 0, napi_static, 0 },
+      { "adopt", 0, Adopt, 0, 0, 0, napi_static, 0 },
+      // keep last: left out where there is no Symbol.dispose
+      { nullptr, GetDisposeSymbol(env), Dispose, 0, 0, 0, napi_default, 0 },
   };
+  size_t property_count = sizeof(properties) / sizeof(*properties);
+  if (properties[property_count - 1].name == nullptr) property_count--;
 
   napi_value cons;
-  status =
-      napi_define_class(env, "MyObject", NAPI_AUTO_LENGTH, New, nullptr, 3, properties, &cons);
+  status = napi_define_class(env, "MyObject", NAPI_AUTO_LENGTH, New, nullptr,
+                             property_count, properties, &cons);
   assert(status == napi_ok);
 
   status = napi_create_reference(env, cons, 1, &constructor);
   assert(status == napi_ok);
 
+  status = napi_add_env_cleanup_hook(env, ReleaseSlabs, env);
+  assert(status == napi_ok);
+
+  {
+    std::lock_guard<std::mutex> lock(transfers_mutex);
+    loaded_envs++;
+  }
+  status = napi_add_env_cleanup_hook(env, ForgetTransfers, nullptr);
+  assert(status == napi_ok);
+
   status = napi_set_named_property(env, exports, "MyObject", cons);
   assert(status == napi_ok);
   return exports;
 }
 
+// Set by Adopt() for the New() call that wraps an object which was
+// transferred from another thread, instead of making a new one.
+static thread_local const TransferredObject* pending_object = nullptr;
+
 napi_value MyObject::New(napi_env env, napi_callback_info info) {
   napi_status status;
 
@@ -52,18 +242,33 @@ napi_value MyObject::New(napi_env env, napi_callback_info info) {
     status = napi_get_cb_info(env, info, &argc, args, &jsthis, nullptr);
     assert(status == napi_ok);
 
-    double value = 0;
+    const TransferredObject* transferred = pending_object;
+    pending_object = nullptr;
 
-    napi_valuetype valuetype;
-    status = napi_typeof(env, args[0], &valuetype);
-    assert(status == napi_ok);
+    MyObject* obj;
+    size_t grown;
+    if (transferred != nullptr) {
+      obj = new (allocator.Allocate(&grown)) MyObject(transferred->value);
+      obj->born_ = transferred->born;
+    } else {
+      double value = 0;
 
-    if (valuetype != napi_undefined) {
-      status = napi_get_value_double(env, args[0], &value);
+      napi_valuetype valuetype;
+      status = napi_typeof(env, args[0], &valuetype);
       assert(status == napi_ok);
-    }
 
-    MyObject* obj = new MyObject(value);
+      if (valuetype != napi_undefined) {
+        status = napi_get_value_double(env, args[0], &value);
+        assert(status == napi_ok);
+      }
+
+      obj = new (allocator.Allocate(&grown)) MyObject(value);
+      stats.Constructed();
+    }
+    if (grown > 0) {
+      status = stats.Reserved(env, grown);
+      assert(status == napi_ok);
+    }
 
     obj->env_ = env;
     status = napi_wrap(env,
@@ -71,8 +276,14 @@ napi_value MyObject::New(napi_env env, napi_callback_info info) {
                        reinterpret_cast<void*>(obj),
                        MyObject::Destructor,
                        nullptr,  // finalize_hint
-                       &obj->wrapper_);
+                       kKeepWrapperRef ? &obj->wrapper_ : nullptr);
+    assert(status == napi_ok);
+    if (kKeepWrapperRef) stats.RefCreated();
+
+#ifndef MYOBJECT_NO_TYPE_TAG
+    status = napi_type_tag_object(env, jsthis, &kMyObjectTag);
     assert(status == napi_ok);
+#endif
 
     return jsthis;
   } else {
@@ -104,9 +315,8 @@ napi_value MyObject::GetValue(napi_env env, napi_callback_info info) {
   status = napi_get_cb_info(env, info, nullptr, nullptr, &jsthis, nullptr);
   assert(status == napi_ok);
 
-  MyObject* obj;
-  status = napi_unwrap(env, jsthis, reinterpret_cast<void**>(&obj));
-  assert(status == napi_ok);
+  MyObject* obj = Unwrap(env, jsthis);
+  if (obj == nullptr) return nullptr;
 
   napi_value num;
   status = napi_create_double(env, obj->value_, &num);
@@ -124,10 +334,8 @@ napi_value MyObject::SetValue(napi_env env, napi_callback_info info) {
   status = napi_get_cb_info(env, info, &argc, &value, &jsthis, nullptr);
   assert(status == napi_ok);
 
-
-  MyObject* obj;
-  status = napi_unwrap(env, jsthis, reinterpret_cast<void**>(&obj));
-  assert(status == napi_ok);
+  MyObject* obj = Unwrap(env, jsthis);
+  if (obj == nullptr) return nullptr;
 
   status = napi_get_value_double(env, value, &obj->value_);
   assert(status == napi_ok);
@@ -142,9 +350,8 @@ napi_value MyObject::PlusOne(napi_env env, napi_callback_info info) {
   status = napi_get_cb_info(env, info, nullptr, nullptr, &jsthis, nullptr);
   assert(status == napi_ok);
 
-  MyObject* obj;
-  status = napi_unwrap(env, jsthis, reinterpret_cast<void**>(&obj));
-  assert(status == napi_ok);
+  MyObject* obj = UnwrapThis(env, jsthis);
+  if (obj == nullptr) return nullptr;
 
   obj->value_ += 1;
 
@@ -155,11 +362,14 @@ napi_value MyObject::PlusOne(napi_env env, napi_callback_info info) {
   return num;
 }
 
+// multiply(k[, target]) returns a new MyObject holding value * k,
+// or stores it in `target`, an existing MyObject, and returns that
+// instead so arithmetic chains need not allocate.
 napi_value MyObject::Multiply(napi_env env, napi_callback_info info) {
   napi_status status;
 
-  size_t argc = 1;
-  napi_value args[1];
+  size_t argc = 2;
+  napi_value args[2];
   napi_value jsthis;
   status = napi_get_cb_info(env, info, &argc, args, &jsthis, nullptr);
   assert(status == napi_ok);
@@ -174,10 +384,20 @@ napi_value MyObject::Multiply(napi_env env, napi_callback_info info) {
     assert(status == napi_ok);
   }
 
-  MyObject* obj;
-  status = napi_unwrap(env, jsthis, reinterpret_cast<void**>(&obj));
+  MyObject* obj = UnwrapThis(env, jsthis);
+  if (obj == nullptr) return nullptr;
+
+  status = napi_typeof(env, args[1], &valuetype);
   assert(status == napi_ok);
 
+  if (valuetype != napi_undefined) {
+    MyObject* target = Unwrap(env, args[1], "target must be a MyObject");
+    if (target == nullptr) return nullptr;
+
+    target->value_ = obj->value_ * multiple;
+    return args[1];
+  }
+
   napi_value cons;
   status = napi_get_reference_value(env, constructor, &cons);
   assert(status == napi_ok);
@@ -193,3 +413,289 @@ napi_value MyObject::Multiply(napi_env env, napi_callback_info info) {
 
   return instance;
 }
+
+// Reads the single optional number argument of the in-place
+// methods and the object they were called on; NULL after throwing.
+static MyObject* GetInPlaceArgs(napi_env env,
+                                napi_callback_info info,
+                                double default_value,
+                                double* operand,
+                                napi_value* jsthis) {
+  napi_status status;
+
+  size_t argc = 1;
+  napi_value args[1];
+  status = napi_get_cb_info(env, info, &argc, args, jsthis, nullptr);
+  assert(status == napi_ok);
+
+  napi_valuetype valuetype;
+  status = napi_typeof(env, args[0], &valuetype);
+  assert(status == napi_ok);
+
+  *operand = default_value;
+  if (valuetype != napi_undefined) {
+    status = napi_get_value_double(env, args[0], operand);
+    assert(status == napi_ok);
+  }
+
+  return UnwrapThis(env, *jsthis);
+}
+
+// multiplyInPlace(k) and addInPlace(k) change this object and
+// return it, so they can be chained without creating objects.
+napi_value MyObject::MultiplyInPlace(napi_env env, napi_callback_info info) {
+  double multiple;
+  napi_value jsthis;
+  MyObject* obj = GetInPlaceArgs(env, info, 1, &multiple, &jsthis);
+  if (obj == nullptr) return nullptr;
+
+  obj->value_ *= multiple;
+
+  return jsthis;
+}
+
+napi_value MyObject::AddInPlace(napi_env env, napi_callback_info info) {
+  double addend;
+  napi_value jsthis;
+  MyObject* obj = GetInPlaceArgs(env, info, 0, &addend, &jsthis);
+  if (obj == nullptr) return nullptr;
+
+  obj->value_ += addend;
+
+  return jsthis;
+}
+
+bool GetTypedArray(napi_env env,
+                   napi_value value,
+                   napi_typedarray_type expected,
+                   const char* message,
+                   void** data,
+                   size_t* length) {
+  napi_status status;
+
+  bool is_typedarray;
+  status = napi_is_typedarray(env, value, &is_typedarray);
+  assert(status == napi_ok);
+
+  napi_typedarray_type type;
+  if (is_typedarray) {
+    status = napi_get_typedarray_info(
+        env, value, &type, length, data, nullptr, nullptr);
+    assert(status == napi_ok);
+  }
+
+  if (!is_typedarray || type != expected) {
+    napi_throw_type_error(env, nullptr, message);
+    return false;
+  }
+  return true;
+}
+
+// apply(opcodes, operands[, out]) runs a whole sequence of ops on
+// this object in one call instead of one call per op. The result
+// after op i is written to out[i] when `out` is given.
+napi_value MyObject::Apply(napi_env env, napi_callback_info info) {
+  napi_status status;
+
+  size_t argc = 3;
+  napi_value args[3];
+  napi_value jsthis;
+  status = napi_get_cb_info(env, info, &argc, args, &jsthis, nullptr);
+  assert(status == napi_ok);
+
+  MyObject* obj = UnwrapThis(env, jsthis);
+  if (obj == nullptr) return nullptr;
+
+  void* data;
+  size_t count;
+  if (!GetTypedArray(env, args[0], napi_uint8_array,
+                     "opcodes must be a Uint8Array", &data, &count)) {
+    return nullptr;
+  }
+  const uint8_t* ops = static_cast<const uint8_t*>(data);
+
+  size_t operand_count;
+  if (!GetTypedArray(env, args[1], napi_float64_array,
+                     "operands must be a Float64Array", &data, &operand_count)) {
+    return nullptr;
+  }
+  const double* operands = static_cast<const double*>(data);
+
+  double* out = nullptr;
+  if (argc > 2) {
+    napi_valuetype valuetype;
+    status = napi_typeof(env, args[2], &valuetype);
+    assert(status == napi_ok);
+
+    if (valuetype != napi_undefined) {
+      size_t out_count;
+      if (!GetTypedArray(env, args[2], napi_float64_array,
+                         "out must be a Float64Array", &data, &out_count)) {
+        return nullptr;
+      }
+      if (out_count < count) {
+        napi_throw_range_error(env, nullptr, "out is shorter than opcodes");
+        return nullptr;
+      }
+      out = static_cast<double*>(data);
+    }
+  }
+
+  double value = obj->value_;
+  size_t next = 0;
+
+  for (size_t i = 0; i < count; i++) {
+    uint8_t op = ops[i];
+    if (op != kOpPlusOne && next >= operand_count) {
+      napi_throw_range_error(env, nullptr, "not enough operands");
+      return nullptr;
+    }
+
+    switch (op) {
+      case kOpPlusOne: value += 1; break;
+      case kOpMultiply: value *= operands[next++]; break;
+      case kOpAdd: value += operands[next++]; break;
+      default:
+        napi_throw_range_error(env, nullptr, "unknown op code");
+        return nullptr;
+    }
+
+    if (out != nullptr) out[i] = value;
+  }
+
+  // only commit once the whole stream has run
+  obj->value_ = value;
+
+  napi_value num;
+  status = napi_create_double(env, value, &num);
+  assert(status == napi_ok);
+
+  return num;
+}
+
+// dispose() frees the native object now rather than once the wrapper
+// is collected, and puts its slot back on the free list. Any later
+// use of the wrapper throws; disposing it again does nothing.
+napi_value MyObject::Dispose(napi_env env, napi_callback_info info) {
+  napi_status status;
+
+  napi_value jsthis;
+  status = napi_get_cb_info(env, info, nullptr, nullptr, &jsthis, nullptr);
+  assert(status == napi_ok);
+
+  MyObject* obj;
+  status = napi_remove_wrap(env, jsthis, reinterpret_cast<void**>(&obj));
+  if (status == napi_ok) Destructor(env, obj, nullptr);
+
+  return nullptr;
+}
+
+// MyObject.transfer(objects) returns the token for an array of
+// MyObjects.
+napi_value MyObject::Transfer(napi_env env, napi_callback_info info) {
+  napi_status status;
+
+  size_t argc = 1;
+  napi_value args[1];
+  status = napi_get_cb_info(env, info, &argc, args, nullptr, nullptr);
+  assert(status == napi_ok);
+
+  bool is_array;
+  status = napi_is_array(env, args[0], &is_array);
+  assert(status == napi_ok);
+  if (!is_array) {
+    napi_throw_type_error(env, nullptr, "expected an array of MyObjects");
+    return nullptr;
+  }
+
+  uint32_t length;
+  status = napi_get_array_length(env, args[0], &length);
+  assert(status == napi_ok);
+
+  // check them all before detaching any
+  std::vector<napi_value> wrappers(length);
+  for (uint32_t i = 0; i < length; i++) {
+    status = napi_get_element(env, args[0], i, &wrappers[i]);
+    assert(status == napi_ok);
+    if (Unwrap(env, wrappers[i]) == nullptr) return nullptr;
+  }
+
+  std::vector<TransferredObject> objects;
+  objects.reserve(length);
+  for (uint32_t i = 0; i < length; i++) {
+    MyObject* obj;
+    status = napi_remove_wrap(env, wrappers[i], reinterpret_cast<void**>(&obj));
+    if (status != napi_ok) continue;  // listed twice
+
+    // still alive as far as the counters go, just not in this slab
+    TransferredObject transferred = { obj->value_, obj->born_ };
+    objects.push_back(transferred);
+    obj->~MyObject();
+    allocator.Free(obj);
+  }
+
+  uint64_t token;
+  {
+    std::lock_guard<std::mutex> lock(transfers_mutex);
+    token = next_transfer++;
+    transfers[token].swap(objects);
+  }
+
+  napi_value result;
+  status = napi_create_double(env, static_cast<double>(token), &result);
+  assert(status == napi_ok);
+
+  return result;
+}
+
+// MyObject.adopt(token) returns the transferred objects, wrapped for
+// this thread. A token can only be adopted once.
+napi_value MyObject::Adopt(napi_env env, napi_callback_info info) {
+  napi_status status;
+
+  size_t argc = 1;
+  napi_value args[1];
+  status = napi_get_cb_info(env, info, &argc, args, nullptr, nullptr);
+  assert(status == napi_ok);
+
+  double token = 0;
+  status = napi_get_value_double(env, args[0], &token);
+
+  std::vector<TransferredObject> objects;
+  bool found = false;
+  if (status == napi_ok && token >= 1 && token < 9007199254740992.0) {
+    std::lock_guard<std::mutex> lock(transfers_mutex);
+    std::unordered_map<uint64_t, std::vector<TransferredObject> >::iterator it =
+        transfers.find(static_cast<uint64_t>(token));
+    if (it != transfers.end()) {
+      objects.swap(it->second);
+      transfers.erase(it);
+      found = true;
+    }
+  }
+
+  if (!found) {
+    napi_throw_error(env, nullptr, "unknown or already adopted transfer");
+    return nullptr;
+  }
+
+  napi_value cons;
+  status = napi_get_reference_value(env, constructor, &cons);
+  assert(status == napi_ok);
+
+  napi_value result;
+  status = napi_create_array(env, &result);
+  assert(status == napi_ok);
+
+  for (size_t i = 0; i < objects.size(); i++) {
+    napi_value instance;
+    pending_object = &objects[i];
+    status = napi_new_instance(env, cons, 0, nullptr, &instance);
+    assert(status == napi_ok);
+
+    status = napi_set_element(env, result, static_cast<uint32_t>(i), instance);
+    assert(status == napi_ok);
+  }
+
+  return result;
+}
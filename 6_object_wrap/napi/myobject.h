@@ -2,11 +2,39 @@
 #define TEST_ADDONS_NAPI_6_OBJECT_WRAP_MYOBJECT_H_
 
 #include <node_api.h>
+#include "object_stats.h"
+#include "slab_allocator.h"
+
+// Op codes for MyObject.prototype.apply(); ops marked * consume
+// the next entry of the operands array.
+enum MyObjectOp {
+  kOpPlusOne = 0,   // value += 1
+  kOpMultiply = 1,  // value *= operand *
+  kOpAdd = 2,       // value += operand *
+};
+
+// Fetches the contents of `value` if it is a typed array of the
+// given type, and throws a TypeError otherwise.
+bool GetTypedArray(napi_env env,
+                   napi_value value,
+                   napi_typedarray_type expected,
+                   const char* message,
+                   void** data,
+                   size_t* length);
 
 class MyObject {
  public:
   static napi_value Init(napi_env env, napi_value exports);
   static void Destructor(napi_env env, void* nativeObject, void* finalize_hint);
+  static void ReleaseSlabs(void* arg);
+
+  // The MyObject wrapped by `value`, or NULL after throwing a
+  // TypeError with `message` if `value` is anything else.
+  static MyObject* Unwrap(napi_env env,
+                          napi_value value,
+                          const char* message = "expected a MyObject");
+  // The instance counters of all threads, as reported by inspect().
+  static napi_status Stats(napi_env env, napi_value* result);
 
  private:
   explicit MyObject(double value_ = 0);
@@ -17,8 +45,19 @@ class MyObject {
   static napi_value SetValue(napi_env env, napi_callback_info info);
   static napi_value PlusOne(napi_env env, napi_callback_info info);
   static napi_value Multiply(napi_env env, napi_callback_info info);
-  static napi_ref constructor;
+  static napi_value MultiplyInPlace(napi_env env, napi_callback_info info);
+  static napi_value AddInPlace(napi_env env, napi_callback_info info);
+  static napi_value Apply(napi_env env, napi_callback_info info);
+  static napi_value Dispose(napi_env env, napi_callback_info info);
+  static napi_value Transfer(napi_env env, napi_callback_info info);
+  static napi_value Adopt(napi_env env, napi_callback_info info);
+  static void ForgetTransfers(void* arg);
+  // per thread, as every worker loading the addon has its own
+  static thread_local napi_ref constructor;
+  static thread_local SlabAllocator<MyObject> allocator;
+  static ObjectStats stats;
   double value_;
+  int64_t born_;
   napi_env env_;
   napi_ref wrapper_;
 };
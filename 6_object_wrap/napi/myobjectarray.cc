@@ -0,0 +1,565 @@
+#include "myobjectarray.h"
+#include <assert.h>
+#include <string.h>
+#include "myobject.h"
+
+thread_local napi_ref MyObjectArray::constructor;
+thread_local napi_ref MyObjectArray::element_constructor;
+
+MyObjectArray::MyObjectArray() : env_(nullptr), values_(nullptr), length_(0) {}
+
+MyObjectArray::~MyObjectArray() {
+  if (values_ != nullptr) napi_delete_reference(env_, values_);
+}
+
+void MyObjectArray::Destructor(napi_env env, void* nativeObject, void* /*finalize_hint*/) {
+  delete reinterpret_cast<MyObjectArray*>(nativeObject);
+}
+
+// What an at(i) handle wraps. The handle also holds the array's JS
+// object in a read-only property, so `array` outlives it.
+struct Element {
+  MyObjectArray* array;
+  size_t index;
+};
+
+// Arrays and their element handles are tagged with these, so objects
+// handed to the accessors or to the element constructor can be told
+// from any other wrapped object.
+static const napi_type_tag kMyObjectArrayTag = {
+  0x6f626a5f61727261ULL, 0x9e3779b97f4a7c15ULL
+};
+static const napi_type_tag kElementTag = {
+  0x6f626a5f656c656dULL, 0x9e3779b97f4a7c15ULL
+};
+
+// The MyObjectArray wrapped by `value`; NULL after throwing if there
+// is none.
+static MyObjectArray* Unwrap(napi_env env, napi_value value, const char* message) {
+  bool is_array;
+  napi_status status =
+      napi_check_object_type_tag(env, value, &kMyObjectArrayTag, &is_array);
+  if (status != napi_ok || !is_array) {
+    napi_throw_type_error(env, nullptr, message);
+    return nullptr;
+  }
+
+  MyObjectArray* obj;
+  status = napi_unwrap(env, value, reinterpret_cast<void**>(&obj));
+  assert(status == napi_ok);
+  return obj;
+}
+
+#define DECLARE_NAPI_METHOD(name, func)                          \
+  { name, 0, func, 0, 0, 0, napi_default, 0 }
+
+// The bulk kernels. Each is a plain loop over contiguous doubles
+// with no calls in it, which the compiler turns into SIMD code.
+
+static void AddAll(double* values, size_t length, double addend) {
+  for (size_t i = 0; i < length; i++) values[i] += addend;
+}
+
+static void MultiplyAll(double* values, size_t length, double multiple) {
+  for (size_t i = 0; i < length; i++) values[i] *= multiple;
+}
+
+static double SumAll(const double* values, size_t length) {
+  // A single running total makes every add wait for the previous
+  // one and cannot be vectorized without reordering the adds, so
+  // keep independent partial sums and combine them at the end.
+  const size_t kLanes = 8;
+  double partial[kLanes] = {0};
+
+  size_t i = 0;
+  for (; i + kLanes <= length; i += kLanes) {
+    for (size_t l = 0; l < kLanes; l++) partial[l] += values[i + l];
+  }
+
+  double sum = 0;
+  for (size_t l = 0; l < kLanes; l++) sum += partial[l];
+  for (; i < length; i++) sum += values[i];
+  return sum;
+}
+
+napi_value MyObjectArray::Init(napi_env env, napi_value exports) {
+  napi_status status;
+  napi_property_descriptor properties[] = {
+      { "length", 0, 0, GetLength, 0, 0, napi_default, 0 },
+      { "values", 0, 0, GetValues, 0, 0, napi_default, 0 },
+      DECLARE_NAPI_METHOD("at", At),
+      DECLARE_NAPI_METHOD("plusOne", PlusOne),
+      DECLARE_NAPI_METHOD("multiply", Multiply),
+      DECLARE_NAPI_METHOD("sum", Sum),
+      DECLARE_NAPI_METHOD("map", Map),
+  };
+
+  napi_value cons;
+  status = napi_define_class(env, "MyObjectArray", NAPI_AUTO_LENGTH, New,
+                             nullptr, sizeof(properties) / sizeof(*properties),
+                             properties, &cons);
+  assert(status == napi_ok);
+
+  status = napi_create_reference(env, cons, 1, &constructor);
+  assert(status == napi_ok);
+
+  napi_property_descriptor element_properties[] = {
+      { "value", 0, 0, GetElementValue, SetElementValue, 0, napi_default, 0 },
+      DECLARE_NAPI_METHOD("plusOne", ElementPlusOne),
+  };
+
+  napi_value element_cons;
+  status = napi_define_class(
+      env, "MyObjectArrayElement", NAPI_AUTO_LENGTH, NewElement, nullptr,
+      sizeof(element_properties) / sizeof(*element_properties),
+      element_properties, &element_cons);
+  assert(status == napi_ok);
+
+  status = napi_create_reference(env, element_cons, 1, &element_constructor);
+  assert(status == napi_ok);
+
+  status = napi_set_named_property(env, exports, "MyObjectArray", cons);
+  assert(status == napi_ok);
+  return exports;
+}
+
+// new MyObjectArray(length) holds `length` zeros; given a
+// Float64Array it holds a copy of its contents instead.
+napi_value MyObjectArray::New(napi_env env, napi_callback_info info) {
+  napi_status status;
+
+  napi_value target;
+  status = napi_get_new_target(env, info, &target);
+  assert(status == napi_ok);
+  bool is_constructor = target != nullptr;
+
+  size_t argc = 1;
+  napi_value args[1];
+  napi_value jsthis;
+  status = napi_get_cb_info(env, info, &argc, args, &jsthis, nullptr);
+  assert(status == napi_ok);
+
+  if (!is_constructor) {
+    // Invoked as plain function `MyObjectArray(...)`, turn into construct call.
+    napi_value cons;
+    status = napi_get_reference_value(env, constructor, &cons);
+    assert(status == napi_ok);
+
+    napi_value instance;
+    status = napi_new_instance(env, cons, 1, args, &instance);
+    assert(status == napi_ok);
+
+    return instance;
+  }
+
+  napi_valuetype valuetype;
+  status = napi_typeof(env, args[0], &valuetype);
+  assert(status == napi_ok);
+
+  size_t length;
+  const double* source = nullptr;
+  if (valuetype == napi_number) {
+    double requested;
+    status = napi_get_value_double(env, args[0], &requested);
+    assert(status == napi_ok);
+
+    if (!(requested >= 0 && requested <= 0x7fffffff) ||
+        requested != static_cast<size_t>(requested)) {
+      napi_throw_range_error(env, nullptr, "invalid length");
+      return nullptr;
+    }
+    length = static_cast<size_t>(requested);
+  } else {
+    void* data;
+    if (!GetTypedArray(env, args[0], napi_float64_array,
+                       "expected a length or a Float64Array", &data, &length)) {
+      return nullptr;
+    }
+    source = static_cast<const double*>(data);
+  }
+
+  // The buffer belongs to the JS heap, so V8 accounts for it and
+  // frees it once neither the array nor its view is reachable.
+  void* data;
+  napi_value buffer;
+  status = napi_create_arraybuffer(env, length * sizeof(double), &data, &buffer);
+  if (status != napi_ok) {
+    napi_throw_range_error(env, nullptr, "could not allocate values");
+    return nullptr;
+  }
+  if (source != nullptr) {
+    memcpy(data, source, length * sizeof(double));
+  } else {
+    memset(data, 0, length * sizeof(double));
+  }
+
+  napi_value values;
+  status = napi_create_typedarray(
+      env, napi_float64_array, length, buffer, 0, &values);
+  assert(status == napi_ok);
+
+  MyObjectArray* obj = new MyObjectArray();
+  obj->env_ = env;
+  obj->length_ = length;
+  status = napi_create_reference(env, values, 1, &obj->values_);
+  assert(status == napi_ok);
+
+  status = napi_wrap(env,
+                     jsthis,
+                     reinterpret_cast<void*>(obj),
+                     MyObjectArray::Destructor,
+                     nullptr,  // finalize_hint
+                     nullptr);
+  assert(status == napi_ok);
+
+  status = napi_type_tag_object(env, jsthis, &kMyObjectArrayTag);
+  assert(status == napi_ok);
+
+  return jsthis;
+}
+
+bool MyObjectArray::GetData(napi_env env, double** data, size_t* length) {
+  napi_status status;
+
+  napi_value values;
+  status = napi_get_reference_value(env, values_, &values);
+  assert(status == napi_ok);
+
+  // looked up on every call: JS may have detached the buffer since
+  void* raw;
+  status = napi_get_typedarray_info(
+      env, values, nullptr, length, &raw, nullptr, nullptr);
+  assert(status == napi_ok);
+
+  if (*length != length_) {
+    napi_throw_error(env, nullptr, "values buffer has been detached");
+    return false;
+  }
+  *data = static_cast<double*>(raw);
+  return true;
+}
+
+// The receiver of a prototype method, which napi_define_class() lets
+// V8 check. Accessors get no such check and use Unwrap().
+static MyObjectArray* UnwrapThis(napi_env env, napi_value jsthis) {
+  MyObjectArray* obj;
+  napi_status status =
+      napi_unwrap(env, jsthis, reinterpret_cast<void**>(&obj));
+  assert(status == napi_ok);
+  return obj;
+}
+
+napi_value MyObjectArray::GetLength(napi_env env, napi_callback_info info) {
+  napi_status status;
+
+  napi_value jsthis;
+  status = napi_get_cb_info(env, info, nullptr, nullptr, &jsthis, nullptr);
+  assert(status == napi_ok);
+
+  MyObjectArray* obj = Unwrap(env, jsthis, "expected a MyObjectArray");
+  if (obj == nullptr) return nullptr;
+
+  napi_value num;
+  status = napi_create_double(env, static_cast<double>(obj->length_), &num);
+  assert(status == napi_ok);
+
+  return num;
+}
+
+napi_value MyObjectArray::GetValues(napi_env env, napi_callback_info info) {
+  napi_status status;
+
+  napi_value jsthis;
+  status = napi_get_cb_info(env, info, nullptr, nullptr, &jsthis, nullptr);
+  assert(status == napi_ok);
+
+  MyObjectArray* obj = Unwrap(env, jsthis, "expected a MyObjectArray");
+  if (obj == nullptr) return nullptr;
+
+  napi_value values;
+  status = napi_get_reference_value(env, obj->values_, &values);
+  assert(status == napi_ok);
+
+  return values;
+}
+
+// Reads the single optional number argument of the bulk methods.
+static void GetBulkArgs(napi_env env,
+                        napi_callback_info info,
+                        double default_value,
+                        double* operand,
+                        napi_value* jsthis) {
+  napi_status status;
+
+  size_t argc = 1;
+  napi_value args[1];
+  status = napi_get_cb_info(env, info, &argc, args, jsthis, nullptr);
+  assert(status == napi_ok);
+
+  napi_valuetype valuetype;
+  status = napi_typeof(env, args[0], &valuetype);
+  assert(status == napi_ok);
+
+  *operand = default_value;
+  if (valuetype != napi_undefined) {
+    status = napi_get_value_double(env, args[0], operand);
+    assert(status == napi_ok);
+  }
+}
+
+// plusOne() and multiply(k) change every value in place and
+// return this.
+napi_value MyObjectArray::PlusOne(napi_env env, napi_callback_info info) {
+  napi_status status;
+
+  napi_value jsthis;
+  status = napi_get_cb_info(env, info, nullptr, nullptr, &jsthis, nullptr);
+  assert(status == napi_ok);
+
+  double* values;
+  size_t length;
+  if (!UnwrapThis(env, jsthis)->GetData(env, &values, &length)) return nullptr;
+
+  AddAll(values, length, 1);
+
+  return jsthis;
+}
+
+napi_value MyObjectArray::Multiply(napi_env env, napi_callback_info info) {
+  double multiple;
+  napi_value jsthis;
+  GetBulkArgs(env, info, 1, &multiple, &jsthis);
+
+  double* values;
+  size_t length;
+  if (!UnwrapThis(env, jsthis)->GetData(env, &values, &length)) return nullptr;
+
+  MultiplyAll(values, length, multiple);
+
+  return jsthis;
+}
+
+napi_value MyObjectArray::Sum(napi_env env, napi_callback_info info) {
+  napi_status status;
+
+  napi_value jsthis;
+  status = napi_get_cb_info(env, info, nullptr, nullptr, &jsthis, nullptr);
+  assert(status == napi_ok);
+
+  double* values;
+  size_t length;
+  if (!UnwrapThis(env, jsthis)->GetData(env, &values, &length)) return nullptr;
+
+  napi_value num;
+  status = napi_create_double(env, SumAll(values, length), &num);
+  assert(status == napi_ok);
+
+  return num;
+}
+
+// map(opcodes, operands) runs the same op stream as
+// MyObject.prototype.apply() on every value, one op at a time over
+// the whole array. Returns this.
+napi_value MyObjectArray::Map(napi_env env, napi_callback_info info) {
+  napi_status status;
+
+  size_t argc = 2;
+  napi_value args[2];
+  napi_value jsthis;
+  status = napi_get_cb_info(env, info, &argc, args, &jsthis, nullptr);
+  assert(status == napi_ok);
+
+  void* data;
+  size_t count;
+  if (!GetTypedArray(env, args[0], napi_uint8_array,
+                     "opcodes must be a Uint8Array", &data, &count)) {
+    return nullptr;
+  }
+  const uint8_t* ops = static_cast<const uint8_t*>(data);
+
+  size_t operand_count;
+  if (!GetTypedArray(env, args[1], napi_float64_array,
+                     "operands must be a Float64Array", &data, &operand_count)) {
+    return nullptr;
+  }
+  const double* operands = static_cast<const double*>(data);
+
+  // check the whole stream first, so a bad one changes nothing
+  size_t needed = 0;
+  for (size_t i = 0; i < count; i++) {
+    switch (ops[i]) {
+      case kOpPlusOne: break;
+      case kOpMultiply:
+      case kOpAdd: needed++; break;
+      default:
+        napi_throw_range_error(env, nullptr, "unknown op code");
+        return nullptr;
+    }
+  }
+  if (needed > operand_count) {
+    napi_throw_range_error(env, nullptr, "not enough operands");
+    return nullptr;
+  }
+
+  double* values;
+  size_t length;
+  if (!UnwrapThis(env, jsthis)->GetData(env, &values, &length)) return nullptr;
+
+  size_t next = 0;
+  for (size_t i = 0; i < count; i++) {
+    switch (ops[i]) {
+      case kOpPlusOne: AddAll(values, length, 1); break;
+      case kOpMultiply: MultiplyAll(values, length, operands[next++]); break;
+      case kOpAdd: AddAll(values, length, operands[next++]); break;
+    }
+  }
+
+  return jsthis;
+}
+
+// at(i) returns a handle whose `value` reads and writes slot i.
+napi_value MyObjectArray::At(napi_env env, napi_callback_info info) {
+  napi_status status;
+
+  size_t argc = 1;
+  napi_value argv[2];
+  status = napi_get_cb_info(env, info, &argc, argv + 1, argv, nullptr);
+  assert(status == napi_ok);
+
+  napi_value cons;
+  status = napi_get_reference_value(env, element_constructor, &cons);
+  assert(status == napi_ok);
+
+  napi_value instance;
+  status = napi_new_instance(env, cons, 2, argv, &instance);
+  if (status != napi_ok) return nullptr;  // NewElement threw
+
+  return instance;
+}
+
+napi_value MyObjectArray::NewElement(napi_env env, napi_callback_info info) {
+  napi_status status;
+
+  size_t argc = 2;
+  napi_value args[2];
+  napi_value jsthis;
+  status = napi_get_cb_info(env, info, &argc, args, &jsthis, nullptr);
+  assert(status == napi_ok);
+
+  const char* message = "use MyObjectArray.prototype.at()";
+  MyObjectArray* array = Unwrap(env, args[0], message);
+  if (array == nullptr) return nullptr;
+  if (argc < 2) {
+    napi_throw_type_error(env, nullptr, message);
+    return nullptr;
+  }
+
+  double index;
+  status = napi_get_value_double(env, args[1], &index);
+  if (status != napi_ok || !(index >= 0 && index < array->length_) ||
+      index != static_cast<size_t>(index)) {
+    napi_throw_range_error(env, nullptr, "index out of range");
+    return nullptr;
+  }
+
+  napi_property_descriptor owner[] = {
+      { "array", 0, 0, 0, 0, args[0], napi_default, 0 },
+  };
+  status = napi_define_properties(env, jsthis, 1, owner);
+  assert(status == napi_ok);
+
+  Element* element = new Element;
+  element->array = array;
+  element->index = static_cast<size_t>(index);
+  status = napi_wrap(env,
+                     jsthis,
+                     reinterpret_cast<void*>(element),
+                     MyObjectArray::ElementDestructor,
+                     nullptr,  // finalize_hint
+                     nullptr);
+  assert(status == napi_ok);
+
+  status = napi_type_tag_object(env, jsthis, &kElementTag);
+  assert(status == napi_ok);
+
+  return jsthis;
+}
+
+void MyObjectArray::ElementDestructor(napi_env env, void* nativeObject, void* /*finalize_hint*/) {
+  delete reinterpret_cast<Element*>(nativeObject);
+}
+
+// The slot an element handle refers to; NULL after throwing. The
+// `value` accessor gets no receiver check from V8, so this does it.
+static double* GetSlot(napi_env env, napi_value jsthis) {
+  bool is_element;
+  napi_status status =
+      napi_check_object_type_tag(env, jsthis, &kElementTag, &is_element);
+  if (status != napi_ok || !is_element) {
+    napi_throw_type_error(env, nullptr, "expected a MyObjectArray element");
+    return nullptr;
+  }
+
+  Element* element;
+  status = napi_unwrap(env, jsthis, reinterpret_cast<void**>(&element));
+  assert(status == napi_ok);
+
+  double* values;
+  size_t length;
+  if (!element->array->GetData(env, &values, &length)) return nullptr;
+  return values + element->index;
+}
+
+napi_value MyObjectArray::GetElementValue(napi_env env, napi_callback_info info) {
+  napi_status status;
+
+  napi_value jsthis;
+  status = napi_get_cb_info(env, info, nullptr, nullptr, &jsthis, nullptr);
+  assert(status == napi_ok);
+
+  double* slot = GetSlot(env, jsthis);
+  if (slot == nullptr) return nullptr;
+
+  napi_value num;
+  status = napi_create_double(env, *slot, &num);
+  assert(status == napi_ok);
+
+  return num;
+}
+
+napi_value MyObjectArray::SetElementValue(napi_env env, napi_callback_info info) {
+  napi_status status;
+
+  size_t argc = 1;
+  napi_value value;
+  napi_value jsthis;
+  status = napi_get_cb_info(env, info, &argc, &value, &jsthis, nullptr);
+  assert(status == napi_ok);
+
+  double* slot = GetSlot(env, jsthis);
+  if (slot == nullptr) return nullptr;
+
+  status = napi_get_value_double(env, value, slot);
+  assert(status == napi_ok);
+
+  return nullptr;
+}
+
+napi_value MyObjectArray::ElementPlusOne(napi_env env, napi_callback_info info) {
+  napi_status status;
+
+  napi_value jsthis;
+  status = napi_get_cb_info(env, info, nullptr, nullptr, &jsthis, nullptr);
+  assert(status == napi_ok);
+
+  double* slot = GetSlot(env, jsthis);
+  if (slot == nullptr) return nullptr;
+
+  *slot += 1;
+
+  napi_value num;
+  status = napi_create_double(env, *slot, &num);
+  assert(status == napi_ok);
+
+  return num;
+}
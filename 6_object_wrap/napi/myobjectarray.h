@@ -0,0 +1,46 @@
+#ifndef TEST_ADDONS_NAPI_6_OBJECT_WRAP_MYOBJECTARRAY_H_
+#define TEST_ADDONS_NAPI_6_OBJECT_WRAP_MYOBJECTARRAY_H_
+
+#include <node_api.h>
+
+// Many MyObject values stored side by side in one buffer, which is
+// also visible to JS as the Float64Array `values`. The bulk methods
+// run one tight loop over the whole buffer instead of one call and
+// one object per value.
+class MyObjectArray {
+ public:
+  static napi_value Init(napi_env env, napi_value exports);
+  static void Destructor(napi_env env, void* nativeObject, void* finalize_hint);
+
+  // The current contents; false after throwing if the buffer has
+  // been detached, e.g. transferred to a worker.
+  bool GetData(napi_env env, double** data, size_t* length);
+
+ private:
+  MyObjectArray();
+  ~MyObjectArray();
+
+  static napi_value New(napi_env env, napi_callback_info info);
+  static napi_value GetLength(napi_env env, napi_callback_info info);
+  static napi_value GetValues(napi_env env, napi_callback_info info);
+  static napi_value At(napi_env env, napi_callback_info info);
+  static napi_value PlusOne(napi_env env, napi_callback_info info);
+  static napi_value Multiply(napi_env env, napi_callback_info info);
+  static napi_value Sum(napi_env env, napi_callback_info info);
+  static napi_value Map(napi_env env, napi_callback_info info);
+
+  // at(i) handles: a view of one slot, not a copy of it.
+  static napi_value NewElement(napi_env env, napi_callback_info info);
+  static void ElementDestructor(napi_env env, void* nativeObject, void* finalize_hint);
+  static napi_value GetElementValue(napi_env env, napi_callback_info info);
+  static napi_value SetElementValue(napi_env env, napi_callback_info info);
+  static napi_value ElementPlusOne(napi_env env, napi_callback_info info);
+
+  static thread_local napi_ref constructor;
+  static thread_local napi_ref element_constructor;
+  napi_env env_;
+  napi_ref values_;
+  size_t length_;
+};
+
+#endif  // TEST_ADDONS_NAPI_6_OBJECT_WRAP_MYOBJECTARRAY_H_
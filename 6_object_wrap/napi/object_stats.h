@@ -0,0 +1,105 @@
+#ifndef TEST_ADDONS_NAPI_6_OBJECT_WRAP_OBJECT_STATS_H_
+#define TEST_ADDONS_NAPI_6_OBJECT_WRAP_OBJECT_STATS_H_
+
+#include <node_api.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <atomic>
+#include <chrono>
+
+// Counters for the instances of one wrapped class, summed over all
+// threads. Every update is a relaxed atomic add, so keeping them
+// costs a few nanoseconds per instance.
+//
+// N-API does not say when a wrapper became unreachable, only when it
+// is finalized, so the age of instances at finalization is kept as
+// the measure of how far finalizers lag behind.
+class ObjectStats {
+ public:
+  // A monotonic clock in nanoseconds, for the `born` timestamps.
+  static int64_t Now() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+  }
+
+  void Constructed() { constructed_.fetch_add(1, std::memory_order_relaxed); }
+
+  // `born` is what Now() returned when the instance was constructed.
+  void Finalized(int64_t born) {
+    int64_t age = Now() - born;
+    finalized_.fetch_add(1, std::memory_order_relaxed);
+    age_total_.fetch_add(age, std::memory_order_relaxed);
+
+    int64_t max = age_max_.load(std::memory_order_relaxed);
+    while (age > max &&
+           !age_max_.compare_exchange_weak(max, age, std::memory_order_relaxed)) {
+    }
+  }
+
+  void RefCreated() { refs_.fetch_add(1, std::memory_order_relaxed); }
+  void RefDeleted() { refs_.fetch_sub(1, std::memory_order_relaxed); }
+
+  // Native memory reserved for instances, such as a new slab, which
+  // is also reported to V8 so that it counts towards GC pressure.
+  napi_status Reserved(napi_env env, size_t bytes) {
+    reserved_.fetch_add(static_cast<int64_t>(bytes), std::memory_order_relaxed);
+    int64_t adjusted;
+    return napi_adjust_external_memory(
+        env, static_cast<int64_t>(bytes), &adjusted);
+  }
+
+  // Undoes Reserved() for memory given back to the system.
+  napi_status Released(napi_env env, size_t bytes) {
+    reserved_.fetch_sub(static_cast<int64_t>(bytes), std::memory_order_relaxed);
+    int64_t adjusted;
+    return napi_adjust_external_memory(
+        env, -static_cast<int64_t>(bytes), &adjusted);
+  }
+
+  // The counters as a plain object; `instance_size` is the native
+  // size of one instance.
+  napi_status ToObject(napi_env env, size_t instance_size, napi_value* result) const {
+    int64_t constructed = constructed_.load(std::memory_order_relaxed);
+    int64_t finalized = finalized_.load(std::memory_order_relaxed);
+    int64_t live = constructed - finalized;
+    double age_total = static_cast<double>(age_total_.load(std::memory_order_relaxed));
+
+    napi_status status = napi_create_object(env, result);
+    if (status != napi_ok) return status;
+
+    const struct {
+      const char* name;
+      double value;
+    } fields[] = {
+        { "live", static_cast<double>(live) },
+        { "liveBytes", static_cast<double>(live) * instance_size },
+        { "reservedBytes", static_cast<double>(reserved_.load(std::memory_order_relaxed)) },
+        { "refs", static_cast<double>(refs_.load(std::memory_order_relaxed)) },
+        { "constructed", static_cast<double>(constructed) },
+        { "finalized", static_cast<double>(finalized) },
+        { "meanAgeAtFinalizeMs", finalized > 0 ? age_total / finalized / 1e6 : 0 },
+        { "maxAgeAtFinalizeMs", age_max_.load(std::memory_order_relaxed) / 1e6 },
+    };
+
+    for (size_t i = 0; i < sizeof(fields) / sizeof(*fields); i++) {
+      napi_value value;
+      status = napi_create_double(env, fields[i].value, &value);
+      if (status != napi_ok) return status;
+      status = napi_set_named_property(env, *result, fields[i].name, value);
+      if (status != napi_ok) return status;
+    }
+
+    return napi_ok;
+  }
+
+ private:
+  std::atomic<int64_t> constructed_{0};
+  std::atomic<int64_t> finalized_{0};
+  std::atomic<int64_t> refs_{0};
+  std::atomic<int64_t> reserved_{0};
+  std::atomic<int64_t> age_total_{0};
+  std::atomic<int64_t> age_max_{0};
+};
+
+#endif  // TEST_ADDONS_NAPI_6_OBJECT_WRAP_OBJECT_STATS_H_
@@ -0,0 +1,37 @@
+const { Worker, isMainThread, parentPort } = require('worker_threads');
+const addon = require('bindings')('addon');
+
+// Hands MyObjects to a worker and back.
+if (isMainThread) {
+  const objs = [ new addon.MyObject(10), new addon.MyObject(20) ];
+  const token = addon.MyObject.transfer(objs);
+
+  try {
+    objs[0].plusOne();
+  } catch (e) {
+    console.log( e.message ); // MyObject has been disposed or transferred
+  }
+
+  const worker = new Worker(__filename);
+  worker.on('message', (token) => {
+    const back = addon.MyObject.adopt(token);
+    console.log( back.map((obj) => obj.value) ); // [ 11, 21 ]
+  });
+  worker.postMessage(token);
+
+  // A token that is never adopted does not keep slots: making as many
+  // objects again reuses them instead of reserving another slab.
+  const reserved = () => addon.inspect().MyObject.reservedBytes;
+  const many = Array.from({ length: 1000 }, (_, i) => new addon.MyObject(i));
+  addon.MyObject.transfer(many);  // token dropped
+  const before = reserved();
+  const again = Array.from({ length: 1000 }, (_, i) => new addon.MyObject(i));
+  console.log( reserved() === before ); // true
+} else {
+  parentPort.once('message', (token) => {
+    const objs = addon.MyObject.adopt(token);
+    for (const obj of objs) obj.plusOne();
+    parentPort.postMessage(addon.MyObject.transfer(objs));
+    parentPort.close();
+  });
+}
@@ -1,4 +1,6 @@
+#include "interned.h"
 #include "myobject.h"
+#include "sharedcounter.h"
 #include <assert.h>
 
 napi_value CreateObject(napi_env env, napi_callback_info info) {
@@ -11,11 +13,73 @@ napi_value CreateObject(napi_env env, napi_callback_info info) {
 
   napi_value instance;
   status = MyObject::NewInstance(env, args[0], &instance);
-  assert(status == napi_ok);
+  if (status != napi_ok) {
+    bool pending;
+    napi_is_exception_pending(env, &pending);
+    if (!pending) napi_throw_type_error(env, nullptr, "expected a number");
+    return nullptr;
+  }
 
   return instance;
 }
 
+// createObjects(values) makes one object per entry of a
+// Float64Array, all in a single call.
+napi_value CreateObjects(napi_env env, napi_callback_info info) {
+  napi_status status;
+
+  size_t argc = 1;
+  napi_value args[1];
+  status = napi_get_cb_info(env, info, &argc, args, nullptr, nullptr);
+  assert(status == napi_ok);
+
+  bool is_typedarray;
+  status = napi_is_typedarray(env, args[0], &is_typedarray);
+  assert(status == napi_ok);
+
+  napi_typedarray_type type;
+  size_t length;
+  void* data;
+  if (is_typedarray) {
+    status = napi_get_typedarray_info(
+        env, args[0], &type, &length, &data, nullptr, nullptr);
+    assert(status == napi_ok);
+  }
+
+  if (!is_typedarray || type != napi_float64_array) {
+    napi_throw_type_error(env, nullptr, "values must be a Float64Array");
+    return nullptr;
+  }
+
+  napi_value array;
+  status = MyObject::NewInstances(
+      env, static_cast<const double*>(data), length, &array);
+  if (status != napi_ok) {
+    napi_throw_error(env, nullptr, "could not create objects");
+    return nullptr;
+  }
+
+  return array;
+}
+
+// inspect() returns the live-object counters of each wrapped class.
+napi_value Inspect(napi_env env, napi_callback_info info) {
+  napi_status status;
+
+  napi_value result;
+  status = napi_create_object(env, &result);
+  assert(status == napi_ok);
+
+  napi_value stats;
+  status = MyObject::Stats(env, &stats);
+  assert(status == napi_ok);
+
+  status = napi_set_named_property(env, result, "MyObject", stats);
+  assert(status == napi_ok);
+
+  return result;
+}
+
 napi_value Init(napi_env env, napi_value exports) {
   napi_status status = MyObject::Init(env);
   assert(status == napi_ok);
@@ -24,6 +88,28 @@ napi_value Init(napi_env env, napi_value exports) {
   status =
       napi_create_function(env, "", NAPI_AUTO_LENGTH, CreateObject, nullptr, &new_exports);
   assert(status == napi_ok);
+
+  napi_value create_objects;
+  status = napi_create_function(env, "createObjects", NAPI_AUTO_LENGTH,
+                                CreateObjects, nullptr, &create_objects);
+  assert(status == napi_ok);
+
+  status = napi_set_named_property(env, new_exports, "createObjects", create_objects);
+  assert(status == napi_ok);
+
+  napi_value inspect;
+  status = napi_create_function(
+      env, "inspect", NAPI_AUTO_LENGTH, Inspect, nullptr, &inspect);
+  assert(status == napi_ok);
+
+  status = napi_set_named_property(env, new_exports, "inspect", inspect);
+  assert(status == napi_ok);
+
+  status = SharedCounter::Init(env, new_exports);
+  assert(status == napi_ok);
+
+  status = InternedObject::Init(env, new_exports);
+  assert(status == napi_ok);
   return new_exports;
 }
 
@@ -9,3 +9,25 @@ var obj2 = createObject(20);
 console.log( obj2.plusOne() ); // 21
 console.log( obj2.plusOne() ); // 22
 console.log( obj2.plusOne() ); // 23
+
+// many objects in one call
+var objs = createObject.createObjects(new Float64Array([1, 2, 3]));
+console.log( objs.length ); // 3
+console.log( objs[2].plusOne() ); // 4
+
+// free the native side now instead of waiting for the GC
+obj2.dispose();
+try {
+  obj2.plusOne();
+} catch (e) {
+  console.log( e.message ); // MyObject has been disposed
+}
+
+// immutable objects, one instance per value
+var a = createObject.intern(5);
+console.log( a === createObject.intern(5) ); // true
+console.log( a.plusOne() === createObject.intern(6) ); // true
+console.log( a.value ); // 5
+
+// native memory held by wrapped objects, summed over all threads
+console.log( createObject.inspect().MyObject.constructed );
@@ -0,0 +1,244 @@
+#include "interned.h"
+#include <assert.h>
+#include <math.h>
+#include <string.h>
+
+thread_local napi_ref InternedObject::constructor;
+thread_local std::unordered_map<uint64_t, InternedObject*> InternedObject::table;
+
+// The table key of a value: its bits, so that 0 and -0 stay apart
+// as with Object.is(), except that every NaN is the same value.
+static uint64_t KeyOf(double value) {
+  if (isnan(value)) value = NAN;
+  uint64_t key;
+  memcpy(&key, &value, sizeof(key));
+  return key;
+}
+
+InternedObject::InternedObject(double value)
+    : value_(value), env_(nullptr), wrapper_(nullptr) {}
+
+InternedObject::~InternedObject() {
+  if (wrapper_ != nullptr) napi_delete_reference(env_, wrapper_);
+}
+
+void InternedObject::Destructor(napi_env env, void* nativeObject, void* /*finalize_hint*/) {
+  InternedObject* obj = reinterpret_cast<InternedObject*>(nativeObject);
+
+  // the table may already point at a newer instance for this value
+  std::unordered_map<uint64_t, InternedObject*>::iterator it =
+      table.find(KeyOf(obj->value_));
+  if (it != table.end() && it->second == obj) table.erase(it);
+
+  delete obj;
+}
+
+#define DECLARE_NAPI_METHOD(name, func)                          \
+  { name, 0, func, 0, 0, 0, napi_default, 0 }
+
+napi_status InternedObject::Init(napi_env env, napi_value exports) {
+  napi_status status;
+  napi_property_descriptor properties[] = {
+      { "value", 0, 0, GetValue, 0, 0, napi_default, 0 },
+      DECLARE_NAPI_METHOD("plusOne", PlusOne),
+      DECLARE_NAPI_METHOD("multiply", Multiply),
+  };
+
+  napi_value cons;
+  status = napi_define_class(env, "InternedObject", NAPI_AUTO_LENGTH, New,
+                             nullptr, sizeof(properties) / sizeof(*properties),
+                             properties, &cons);
+  if (status != napi_ok) return status;
+
+  status = napi_create_reference(env, cons, 1, &constructor);
+  if (status != napi_ok) return status;
+
+  napi_value intern;
+  status = napi_create_function(
+      env, "intern", NAPI_AUTO_LENGTH, Create, nullptr, &intern);
+  if (status != napi_ok) return status;
+
+  return napi_set_named_property(env, exports, "intern", intern);
+}
+
+// Every instance is tagged with this, so the `value` accessor, which
+// V8 runs on any receiver, can tell an instance from other objects.
+static const napi_type_tag kInternedTag = {
+  0x696e7465726e6564ULL, 0x9e3779b97f4a7c15ULL
+};
+
+// Set by Intern() for the single New() call it makes.
+static thread_local const double* pending_value = nullptr;
+
+napi_value InternedObject::New(napi_env env, napi_callback_info info) {
+  napi_status status;
+
+  napi_value jsthis;
+  status = napi_get_cb_info(env, info, nullptr, nullptr, &jsthis, nullptr);
+  assert(status == napi_ok);
+
+  if (pending_value == nullptr) {
+    napi_throw_type_error(env, nullptr, "use intern() to get an instance");
+    return nullptr;
+  }
+
+  InternedObject* obj = new InternedObject(*pending_value);
+  pending_value = nullptr;
+
+  // the reference napi_wrap() returns has a count of 0, i.e. is weak
+  obj->env_ = env;
+  status = napi_wrap(env,
+                     jsthis,
+                     reinterpret_cast<void*>(obj),
+                     InternedObject::Destructor,
+                     nullptr, /* finalize_hint */
+                     &obj->wrapper_);
+  assert(status == napi_ok);
+
+  // before freezing, while a tag can still be added
+  status = napi_type_tag_object(env, jsthis, &kInternedTag);
+  assert(status == napi_ok);
+
+  status = napi_object_freeze(env, jsthis);
+  assert(status == napi_ok);
+
+  return jsthis;
+}
+
+napi_status InternedObject::Intern(napi_env env,
+                                   double value,
+                                   napi_value* instance) {
+  napi_status status;
+
+  uint64_t key = KeyOf(value);
+  std::unordered_map<uint64_t, InternedObject*>::iterator it = table.find(key);
+  if (it != table.end()) {
+    status = napi_get_reference_value(env, it->second->wrapper_, instance);
+    if (status != napi_ok) return status;
+
+    // NULL once collected, even if not finalized yet
+    if (*instance != nullptr) return napi_ok;
+  }
+
+  napi_value cons;
+  status = napi_get_reference_value(env, constructor, &cons);
+  if (status != napi_ok) return status;
+
+  pending_value = &value;
+  status = napi_new_instance(env, cons, 0, nullptr, instance);
+  pending_value = nullptr;
+  if (status != napi_ok) return status;
+
+  InternedObject* obj;
+  status = napi_unwrap(env, *instance, reinterpret_cast<void**>(&obj));
+  if (status != napi_ok) return status;
+
+  table[key] = obj;
+  return napi_ok;
+}
+
+static napi_value ReturnInterned(napi_env env, double value) {
+  napi_value instance;
+  napi_status status = InternedObject::Intern(env, value, &instance);
+  assert(status == napi_ok);
+  return instance;
+}
+
+// intern(value) is the instance holding `value`.
+napi_value InternedObject::Create(napi_env env, napi_callback_info info) {
+  napi_status status;
+
+  size_t argc = 1;
+  napi_value args[1];
+  status = napi_get_cb_info(env, info, &argc, args, nullptr, nullptr);
+  assert(status == napi_ok);
+
+  double value = 0;
+  napi_valuetype valuetype;
+  status = napi_typeof(env, args[0], &valuetype);
+  assert(status == napi_ok);
+
+  if (valuetype != napi_undefined) {
+    status = napi_get_value_double(env, args[0], &value);
+    if (status != napi_ok) {
+      napi_throw_type_error(env, nullptr, "expected a number");
+      return nullptr;
+    }
+  }
+
+  return ReturnInterned(env, value);
+}
+
+// The instance `jsthis` is, or NULL after throwing a TypeError.
+static InternedObject* Unwrap(napi_env env, napi_value jsthis) {
+  bool is_interned;
+  napi_status status =
+      napi_check_object_type_tag(env, jsthis, &kInternedTag, &is_interned);
+  if (status != napi_ok || !is_interned) {
+    napi_throw_type_error(env, nullptr, "expected an InternedObject");
+    return nullptr;
+  }
+
+  InternedObject* obj;
+  status = napi_unwrap(env, jsthis, reinterpret_cast<void**>(&obj));
+  assert(status == napi_ok);
+  return obj;
+}
+
+napi_value InternedObject::GetValue(napi_env env, napi_callback_info info) {
+  napi_status status;
+
+  napi_value jsthis;
+  status = napi_get_cb_info(env, info, nullptr, nullptr, &jsthis, nullptr);
+  assert(status == napi_ok);
+
+  InternedObject* obj = Unwrap(env, jsthis);
+  if (obj == nullptr) return nullptr;
+
+  napi_value num;
+  status = napi_create_double(env, obj->value_, &num);
+  assert(status == napi_ok);
+
+  return num;
+}
+
+napi_value InternedObject::PlusOne(napi_env env, napi_callback_info info) {
+  napi_status status;
+
+  napi_value jsthis;
+  status = napi_get_cb_info(env, info, nullptr, nullptr, &jsthis, nullptr);
+  assert(status == napi_ok);
+
+  InternedObject* obj = Unwrap(env, jsthis);
+  if (obj == nullptr) return nullptr;
+
+  return ReturnInterned(env, obj->value_ + 1);
+}
+
+napi_value InternedObject::Multiply(napi_env env, napi_callback_info info) {
+  napi_status status;
+
+  size_t argc = 1;
+  napi_value args[1];
+  napi_value jsthis;
+  status = napi_get_cb_info(env, info, &argc, args, &jsthis, nullptr);
+  assert(status == napi_ok);
+
+  double multiple = 1;
+  napi_valuetype valuetype;
+  status = napi_typeof(env, args[0], &valuetype);
+  assert(status == napi_ok);
+
+  if (valuetype != napi_undefined) {
+    status = napi_get_value_double(env, args[0], &multiple);
+    if (status != napi_ok) {
+      napi_throw_type_error(env, nullptr, "expected a number");
+      return nullptr;
+    }
+  }
+
+  InternedObject* obj = Unwrap(env, jsthis);
+  if (obj == nullptr) return nullptr;
+
+  return ReturnInterned(env, obj->value_ * multiple);
+}
@@ -0,0 +1,42 @@
+#ifndef TEST_ADDONS_NAPI_7_FACTORY_WRAP_INTERNED_H_
+#define TEST_ADDONS_NAPI_7_FACTORY_WRAP_INTERNED_H_
+
+#include <node_api.h>
+#include <stdint.h>
+#include <unordered_map>
+
+/*
+Immutable objects, one per distinct value: createObject.intern(v)
+returns the live instance holding `v` if there is one, and only
+creates a new object otherwise. Instances are frozen, and plusOne()
+and multiply(k) return interned results rather than changing `this`.
+
+The table only holds weak references, so an instance that is no
+longer used elsewhere is still collected.
+*/
+class InternedObject {
+ public:
+  static napi_status Init(napi_env env, napi_value exports);
+  static void Destructor(napi_env env, void* nativeObject, void* finalize_hint);
+  // The live instance holding `value`, created if there is none.
+  static napi_status Intern(napi_env env, double value, napi_value* instance);
+
+ private:
+  explicit InternedObject(double value);
+  ~InternedObject();
+
+  static napi_value Create(napi_env env, napi_callback_info info);
+  static napi_value New(napi_env env, napi_callback_info info);
+  static napi_value GetValue(napi_env env, napi_callback_info info);
+  static napi_value PlusOne(napi_env env, napi_callback_info info);
+  static napi_value Multiply(napi_env env, napi_callback_info info);
+
+  // per thread, as every worker loading the addon has its own
+  static thread_local napi_ref constructor;
+  static thread_local std::unordered_map<uint64_t, InternedObject*> table;
+  double value_;
+  napi_env env_;
+  napi_ref wrapper_;  // weak
+};
+
+#endif  // TEST_ADDONS_NAPI_7_FACTORY_WRAP_INTERNED_H_
@@ -1,66 +1,148 @@
 #include "myobject.h"
 #include <assert.h>
+#include <new>
 
-MyObject::MyObject() : env_(nullptr), wrapper_(nullptr) {}
+ObjectStats MyObject::stats;
 
-MyObject::~MyObject() { napi_delete_reference(env_, wrapper_); }
+MyObject::MyObject()
+    : born_(ObjectStats::Now()), env_(nullptr), wrapper_(nullptr) {
+  stats.Constructed();
+}
+
+MyObject::~MyObject() {
+  if (wrapper_ != nullptr) {
+    napi_delete_reference(env_, wrapper_);
+    stats.RefDeleted();
+  }
+}
+
+// Nothing here reads wrapper_, so skip the reference unless asked.
+#ifdef MYOBJECT_WRAPPER_REF
+static const bool kKeepWrapperRef = true;
+#else
+static const bool kKeepWrapperRef = false;
+#endif
+
+thread_local SlabAllocator<MyObject> MyObject::allocator;
 
 void MyObject::Destructor(napi_env env, void* nativeObject, void* /*finalize_hint*/) {
-  reinterpret_cast<MyObject*>(nativeObject)->~MyObject();
+  MyObject* obj = reinterpret_cast<MyObject*>(nativeObject);
+  stats.Finalized(obj->born_);
+  obj->~MyObject();
+  size_t released = allocator.Free(obj);
+  if (released > 0) stats.Released(env, released);
+}
+
+// Env cleanup hook; see SlabAllocator::Close().
+void MyObject::ReleaseSlabs(void* arg) {
+  size_t released = allocator.Close();
+  if (released > 0) stats.Released(static_cast<napi_env>(arg), released);
+}
+
+napi_status MyObject::Stats(napi_env env, napi_value* result) {
+  return stats.ToObject(env, sizeof(MyObject), result);
 }
 
 #define DECLARE_NAPI_METHOD(name, func)                          \
   { name, 0, func, 0, 0, 0, napi_default, 0 }
 
-napi_ref MyObject::constructor;
+// Symbol.dispose, so `using` declarations dispose of MyObjects;
+// NULL where the runtime does not define it.
+static napi_value GetDisposeSymbol(napi_env env) {
+  napi_status status;
+
+  napi_value global, symbol, dispose;
+  status = napi_get_global(env, &global);
+  assert(status == napi_ok);
+  status = napi_get_named_property(env, global, "Symbol", &symbol);
+  assert(status == napi_ok);
+  status = napi_get_named_property(env, symbol, "dispose", &dispose);
+  assert(status == napi_ok);
+
+  napi_valuetype valuetype;
+  status = napi_typeof(env, dispose, &valuetype);
+  assert(status == napi_ok);
+
+  return valuetype == napi_symbol ? dispose : nullptr;
+}
+
+thread_local napi_ref MyObject::constructor;
 
 napi_status MyObject::Init(napi_env env) {
   napi_status status;
   napi_property_descriptor properties[] = {
       DECLARE_NAPI_METHOD("plusOne", PlusOne),
+      DECLARE_NAPI_METHOD("dispose", Dispose),
+      // keep last: left out where there is no Symbol.dispose
+      { nullptr, GetDisposeSymbol(env), Dispose, 0, 0, 0, napi_default, 0 },
   };
+  size_t property_count = sizeof(properties) / sizeof(*properties);
+  if (properties[property_count - 1].name == nullptr) property_count--;
 
   napi_value cons;
-  status =
-      napi_define_class(env, "MyObject", NAPI_AUTO_LENGTH, New, nullptr, 1, properties, &cons);
+  status = napi_define_class(env, "MyObject", NAPI_AUTO_LENGTH, New, nullptr,
+                             property_count, properties, &cons);
   if (status != napi_ok) return status;
 
   status = napi_create_reference(env, cons, 1, &constructor);
   if (status != napi_ok) return status;
 
+  status = napi_add_env_cleanup_hook(env, ReleaseSlabs, env);
+  if (status != napi_ok) return status;
+
   return napi_ok;
 }
 
+// Set by NewInstance() for the single New() call it makes, so the
+// initial value reaches the object as a double instead of being
+// boxed into a JS argument and parsed back out again.
+static thread_local const double* pending_value = nullptr;
+
 napi_value MyObject::New(napi_env env, napi_callback_info info) {
   napi_status status;
 
-  size_t argc = 1;
-  napi_value args[1];
   napi_value jsthis;
-  status = napi_get_cb_info(env, info, &argc, args, &jsthis, nullptr);
-  assert(status == napi_ok);
-
-  napi_valuetype valuetype;
-  status = napi_typeof(env, args[0], &valuetype);
-  assert(status == napi_ok);
+  double value = 0;
 
-  MyObject* obj = new MyObject();
+  if (pending_value != nullptr) {
+    status = napi_get_cb_info(env, info, nullptr, nullptr, &jsthis, nullptr);
+    assert(status == napi_ok);
 
-  if (valuetype == napi_undefined) {
-    obj->counter_ = 0;
+    value = *pending_value;
+    pending_value = nullptr;
   } else {
-    status = napi_get_value_double(env, args[0], &obj->counter_);
+    size_t argc = 1;
+    napi_value args[1];
+    status = napi_get_cb_info(env, info, &argc, args, &jsthis, nullptr);
     assert(status == napi_ok);
+
+    napi_valuetype valuetype;
+    status = napi_typeof(env, args[0], &valuetype);
+    assert(status == napi_ok);
+
+    if (valuetype != napi_undefined) {
+      status = napi_get_value_double(env, args[0], &value);
+      assert(status == napi_ok);
+    }
   }
 
+  size_t grown;
+  MyObject* obj = new (allocator.Allocate(&grown)) MyObject();
+  if (grown > 0) {
+    status = stats.Reserved(env, grown);
+    assert(status == napi_ok);
+  }
+
+  obj->counter_ = value;
   obj->env_ = env;
   status = napi_wrap(env,
                      jsthis,
                      reinterpret_cast<void*>(obj),
                      MyObject::Destructor,
                      nullptr, /* finalize_hint */
-                     &obj->wrapper_);
+                     kKeepWrapperRef ? &obj->wrapper_ : nullptr);
   assert(status == napi_ok);
+  if (kKeepWrapperRef) stats.RefCreated();
 
   return jsthis;
 }
@@ -70,16 +152,81 @@ napi_status MyObject::NewInstance(napi_env env,
                                   napi_value* instance) {
   napi_status status;
 
-  const int argc = 1;
-  napi_value argv[argc] = {arg};
+  napi_valuetype valuetype;
+  status = napi_typeof(env, arg, &valuetype);
+  if (status != napi_ok) return status;
+
+  double value = 0;
+  if (valuetype != napi_undefined) {
+    status = napi_get_value_double(env, arg, &value);
+    if (status != napi_ok) return status;
+  }
+
+  return NewInstance(env, value, instance);
+}
+
+napi_status MyObject::NewInstance(napi_env env,
+                                  double value,
+                                  napi_value* instance) {
+  napi_status status;
 
   napi_value cons;
   status = napi_get_reference_value(env, constructor, &cons);
   if (status != napi_ok) return status;
 
-  status = napi_new_instance(env, cons, argc, argv, instance);
+  // N-API has no way to make a class instance without running its
+  // constructor, but with no arguments to marshal the call is cheap
+  pending_value = &value;
+  status = napi_new_instance(env, cons, 0, nullptr, instance);
+  pending_value = nullptr;
+  if (status != napi_ok) return status;
+
+  return napi_ok;
+}
+
+napi_status MyObject::NewInstances(napi_env env,
+                                   const double* values,
+                                   size_t count,
+                                   napi_value* array) {
+  napi_status status;
+
+  // one slab for the whole batch, reported to the GC once
+  size_t grown = allocator.Reserve(count);
+  if (grown > 0) {
+    status = stats.Reserved(env, grown);
+    if (status != napi_ok) return status;
+  }
+
+  // not napi_create_array_with_length(): large preallocated arrays
+  // start out in V8's slow dictionary mode, while one filled in
+  // order keeps fast elements
+  status = napi_create_array(env, array);
   if (status != napi_ok) return status;
 
+  // Each instance leaves handles behind in the current scope; close
+  // them every so often instead of keeping a million of them open.
+  const size_t kPerScope = 1024;
+
+  for (size_t first = 0; first < count; first += kPerScope) {
+    size_t last = first + kPerScope < count ? first + kPerScope : count;
+
+    napi_handle_scope scope;
+    status = napi_open_handle_scope(env, &scope);
+    if (status != napi_ok) return status;
+
+    for (size_t i = first; i < last && status == napi_ok; i++) {
+      napi_value instance;
+      status = NewInstance(env, values[i], &instance);
+      if (status == napi_ok) {
+        status = napi_set_element(env, *array, static_cast<uint32_t>(i), instance);
+      }
+    }
+
+    napi_status closed = napi_close_handle_scope(env, scope);
+    if (status != napi_ok) return status;
+    if (closed != napi_ok) return closed;
+  }
+
   return napi_ok;
 }
 
@@ -92,7 +239,10 @@ napi_value MyObject::PlusOne(napi_env env, napi_callback_info info) {
 
   MyObject* obj;
   status = napi_unwrap(env, jsthis, reinterpret_cast<void**>(&obj));
-  assert(status == napi_ok);
+  if (status != napi_ok) {
+    napi_throw_error(env, nullptr, "MyObject has been disposed");
+    return nullptr;
+  }
 
   obj->counter_ += 1;
 
@@ -102,3 +252,20 @@ napi_value MyObject::PlusOne(napi_env env, napi_callback_info info) {
 
   return num;
 }
+
+// dispose() frees the native object now rather than once the wrapper
+// is collected, and puts its slot back on the free list. Any later
+// use of the wrapper throws; disposing it again does nothing.
+napi_value MyObject::Dispose(napi_env env, napi_callback_info info) {
+  napi_status status;
+
+  napi_value jsthis;
+  status = napi_get_cb_info(env, info, nullptr, nullptr, &jsthis, nullptr);
+  assert(status == napi_ok);
+
+  MyObject* obj;
+  status = napi_remove_wrap(env, jsthis, reinterpret_cast<void**>(&obj));
+  if (status == napi_ok) Destructor(env, obj, nullptr);
+
+  return nullptr;
+}
@@ -2,23 +2,43 @@
 #define TEST_ADDONS_NAPI_7_FACTORY_WRAP_MYOBJECT_H_
 
 #include <node_api.h>
+#include "object_stats.h"
+#include "slab_allocator.h"
 
 class MyObject {
  public:
   static napi_status Init(napi_env env);
   static void Destructor(napi_env env, void* nativeObject, void* finalize_hint);
+  static void ReleaseSlabs(void* arg);
   static napi_status NewInstance(napi_env env,
                                  napi_value arg,
                                  napi_value* instance);
+  // Same, from a native value that is never boxed into a JS number.
+  static napi_status NewInstance(napi_env env,
+                                 double value,
+                                 napi_value* instance);
+  // A JS array of `count` new instances, one per value.
+  static napi_status NewInstances(napi_env env,
+                                  const double* values,
+                                  size_t count,
+                                  napi_value* array);
+
+  // The instance counters of all threads, as reported by inspect().
+  static napi_status Stats(napi_env env, napi_value* result);
 
  private:
   MyObject();
   ~MyObject();
 
-  static napi_ref constructor;
+  // per thread, as every worker loading the addon has its own
+  static thread_local napi_ref constructor;
+  static thread_local SlabAllocator<MyObject> allocator;
+  static ObjectStats stats;
   static napi_value New(napi_env env, napi_callback_info info);
   static napi_value PlusOne(napi_env env, napi_callback_info info);
+  static napi_value Dispose(napi_env env, napi_callback_info info);
   double counter_;
+  int64_t born_;
   napi_env env_;
   napi_ref wrapper_;
 };
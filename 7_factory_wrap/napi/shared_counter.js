@@ -0,0 +1,28 @@
+// One counter, incremented from several worker_threads at once.
+var workerThreads = require('worker_threads');
+var createObject = require('bindings')('addon');
+
+var workers = 4;
+var increments = 100000;
+
+if (workerThreads.isMainThread) {
+  var counter = createObject.createSharedCounter(
+      new BigInt64Array(new SharedArrayBuffer(8)));
+  counter.add(10);
+
+  var running = workers;
+  for (var i = 0; i < workers; i++) {
+    // only the shared memory is posted, not every increment
+    new workerThreads.Worker(__filename, { workerData: counter.cells })
+        .on('exit', function() {
+          if (--running === 0) {
+            console.log(counter.value); // 400010
+          }
+        });
+  }
+} else {
+  var counter = createObject.createSharedCounter(workerThreads.workerData);
+  for (var i = 0; i < increments; i++) {
+    counter.plusOne();
+  }
+}
@@ -0,0 +1,222 @@
+#include "sharedcounter.h"
+#include <assert.h>
+
+// the slot is reinterpreted in place, as Atomics do from JS
+static_assert(sizeof(std::atomic<int64_t>) == sizeof(int64_t),
+              "std::atomic<int64_t> must be a plain int64_t");
+
+SharedCounter::SharedCounter()
+    : value_(nullptr), env_(nullptr), cells_(nullptr) {}
+
+SharedCounter::~SharedCounter() {
+  if (cells_ != nullptr) napi_delete_reference(env_, cells_);
+}
+
+void SharedCounter::Destructor(napi_env env, void* nativeObject, void* /*finalize_hint*/) {
+  delete reinterpret_cast<SharedCounter*>(nativeObject);
+}
+
+#define DECLARE_NAPI_METHOD(name, func)                          \
+  { name, 0, func, 0, 0, 0, napi_default, 0 }
+
+thread_local napi_ref SharedCounter::constructor;
+
+// Every counter is tagged with this, so the accessors, which V8 runs
+// on any receiver, can tell a SharedCounter from other objects.
+static const napi_type_tag kSharedCounterTag = {
+  0x7368617265645f63ULL, 0x9e3779b97f4a7c15ULL
+};
+
+napi_status SharedCounter::Init(napi_env env, napi_value exports) {
+  napi_status status;
+  napi_property_descriptor properties[] = {
+      { "value", 0, 0, GetValue, 0, 0, napi_default, 0 },
+      { "cells", 0, 0, GetCells, 0, 0, napi_default, 0 },
+      DECLARE_NAPI_METHOD("plusOne", PlusOne),
+      DECLARE_NAPI_METHOD("add", Add),
+  };
+
+  napi_value cons;
+  status = napi_define_class(env, "SharedCounter", NAPI_AUTO_LENGTH, New,
+                             nullptr, sizeof(properties) / sizeof(*properties),
+                             properties, &cons);
+  if (status != napi_ok) return status;
+
+  status = napi_create_reference(env, cons, 1, &constructor);
+  if (status != napi_ok) return status;
+
+  napi_value create;
+  status = napi_create_function(
+      env, "createSharedCounter", NAPI_AUTO_LENGTH, Create, nullptr, &create);
+  if (status != napi_ok) return status;
+
+  return napi_set_named_property(env, exports, "createSharedCounter", create);
+}
+
+// createSharedCounter(cells) counts in cells[0], where `cells` is
+// a BigInt64Array over a SharedArrayBuffer.
+napi_value SharedCounter::Create(napi_env env, napi_callback_info info) {
+  napi_status status;
+
+  size_t argc = 1;
+  napi_value args[1];
+  status = napi_get_cb_info(env, info, &argc, args, nullptr, nullptr);
+  assert(status == napi_ok);
+
+  napi_value cons;
+  status = napi_get_reference_value(env, constructor, &cons);
+  assert(status == napi_ok);
+
+  napi_value instance;
+  status = napi_new_instance(env, cons, 1, args, &instance);
+  if (status != napi_ok) return nullptr;  // New() threw
+
+  return instance;
+}
+
+napi_value SharedCounter::New(napi_env env, napi_callback_info info) {
+  napi_status status;
+
+  size_t argc = 1;
+  napi_value args[1];
+  napi_value jsthis;
+  status = napi_get_cb_info(env, info, &argc, args, &jsthis, nullptr);
+  assert(status == napi_ok);
+
+  bool is_typedarray;
+  status = napi_is_typedarray(env, args[0], &is_typedarray);
+  assert(status == napi_ok);
+
+  napi_typedarray_type type;
+  size_t length;
+  void* data;
+  napi_value buffer;
+  bool is_arraybuffer = true;
+  if (is_typedarray) {
+    status = napi_get_typedarray_info(
+        env, args[0], &type, &length, &data, &buffer, nullptr);
+    assert(status == napi_ok);
+
+    // the view is over either an ArrayBuffer or a SharedArrayBuffer;
+    // only the latter can be shared, and can never be detached
+    status = napi_is_arraybuffer(env, buffer, &is_arraybuffer);
+    assert(status == napi_ok);
+  }
+
+  if (!is_typedarray || type != napi_bigint64_array || length < 1 ||
+      is_arraybuffer) {
+    napi_throw_type_error(
+        env, nullptr, "cells must be a BigInt64Array over a SharedArrayBuffer");
+    return nullptr;
+  }
+
+  SharedCounter* obj = new SharedCounter();
+  obj->value_ = static_cast<std::atomic<int64_t>*>(data);
+  obj->env_ = env;
+  status = napi_create_reference(env, args[0], 1, &obj->cells_);
+  assert(status == napi_ok);
+
+  status = napi_wrap(env,
+                     jsthis,
+                     reinterpret_cast<void*>(obj),
+                     SharedCounter::Destructor,
+                     nullptr, /* finalize_hint */
+                     nullptr);
+  assert(status == napi_ok);
+
+  status = napi_type_tag_object(env, jsthis, &kSharedCounterTag);
+  assert(status == napi_ok);
+
+  return jsthis;
+}
+
+// The counter `jsthis` is, or NULL after throwing a TypeError.
+static SharedCounter* Unwrap(napi_env env, napi_value jsthis) {
+  bool is_counter;
+  napi_status status =
+      napi_check_object_type_tag(env, jsthis, &kSharedCounterTag, &is_counter);
+  if (status != napi_ok || !is_counter) {
+    napi_throw_type_error(env, nullptr, "expected a SharedCounter");
+    return nullptr;
+  }
+
+  SharedCounter* obj;
+  status = napi_unwrap(env, jsthis, reinterpret_cast<void**>(&obj));
+  assert(status == napi_ok);
+  return obj;
+}
+
+static napi_value CreateCount(napi_env env, int64_t count) {
+  napi_value num;
+  napi_status status =
+      napi_create_double(env, static_cast<double>(count), &num);
+  assert(status == napi_ok);
+  return num;
+}
+
+napi_value SharedCounter::GetValue(napi_env env, napi_callback_info info) {
+  napi_status status;
+
+  napi_value jsthis;
+  status = napi_get_cb_info(env, info, nullptr, nullptr, &jsthis, nullptr);
+  assert(status == napi_ok);
+
+  SharedCounter* obj = Unwrap(env, jsthis);
+  if (obj == nullptr) return nullptr;
+
+  return CreateCount(env, obj->value_->load());
+}
+
+napi_value SharedCounter::GetCells(napi_env env, napi_callback_info info) {
+  napi_status status;
+
+  napi_value jsthis;
+  status = napi_get_cb_info(env, info, nullptr, nullptr, &jsthis, nullptr);
+  assert(status == napi_ok);
+
+  SharedCounter* obj = Unwrap(env, jsthis);
+  if (obj == nullptr) return nullptr;
+
+  napi_value cells;
+  status = napi_get_reference_value(env, obj->cells_, &cells);
+  assert(status == napi_ok);
+
+  return cells;
+}
+
+// plusOne() and add(n) return the value right after their own
+// update, whatever other threads do at the same time.
+napi_value SharedCounter::PlusOne(napi_env env, napi_callback_info info) {
+  napi_status status;
+
+  napi_value jsthis;
+  status = napi_get_cb_info(env, info, nullptr, nullptr, &jsthis, nullptr);
+  assert(status == napi_ok);
+
+  SharedCounter* obj = Unwrap(env, jsthis);
+  if (obj == nullptr) return nullptr;
+
+  return CreateCount(env, obj->value_->fetch_add(1) + 1);
+}
+
+napi_value SharedCounter::Add(napi_env env, napi_callback_info info) {
+  napi_status status;
+
+  size_t argc = 1;
+  napi_value args[1];
+  napi_value jsthis;
+  status = napi_get_cb_info(env, info, &argc, args, &jsthis, nullptr);
+  assert(status == napi_ok);
+
+  int64_t addend;
+  status = napi_get_value_int64(env, args[0], &addend);
+  if (status != napi_ok) {
+    napi_throw_type_error(env, nullptr, "expected a number");
+    return nullptr;
+  }
+
+  SharedCounter* obj = Unwrap(env, jsthis);
+  if (obj == nullptr) return nullptr;
+
+  return CreateCount(env, obj->value_->fetch_add(addend) + addend);
+}
@@ -0,0 +1,37 @@
+#ifndef TEST_ADDONS_NAPI_7_FACTORY_WRAP_SHAREDCOUNTER_H_
+#define TEST_ADDONS_NAPI_7_FACTORY_WRAP_SHAREDCOUNTER_H_
+
+#include <node_api.h>
+#include <stdint.h>
+#include <atomic>
+
+/*
+A counter whose value lives in slot 0 of a BigInt64Array over a
+SharedArrayBuffer, so counters in several worker_threads can share
+it: post `counter.cells` to a worker and wrap it there with
+createSharedCounter(cells) again. All updates are lock-free atomic
+adds, and JS may use Atomics on the same slot.
+*/
+class SharedCounter {
+ public:
+  static napi_status Init(napi_env env, napi_value exports);
+  static void Destructor(napi_env env, void* nativeObject, void* finalize_hint);
+
+ private:
+  SharedCounter();
+  ~SharedCounter();
+
+  static napi_value Create(napi_env env, napi_callback_info info);
+  static napi_value New(napi_env env, napi_callback_info info);
+  static napi_value GetValue(napi_env env, napi_callback_info info);
+  static napi_value GetCells(napi_env env, napi_callback_info info);
+  static napi_value PlusOne(napi_env env, napi_callback_info info);
+  static napi_value Add(napi_env env, napi_callback_info info);
+
+  static thread_local napi_ref constructor;
+  std::atomic<int64_t>* value_;
+  napi_env env_;
+  napi_ref cells_;  // keeps the shared memory mapped in this thread
+};
+
+#endif  // TEST_ADDONS_NAPI_7_FACTORY_WRAP_SHAREDCOUNTER_H_
@@ -0,0 +1,96 @@
+#ifndef TEST_ADDONS_NAPI_7_FACTORY_WRAP_SLAB_ALLOCATOR_H_
+#define TEST_ADDONS_NAPI_7_FACTORY_WRAP_SLAB_ALLOCATOR_H_
+
+#include <stddef.h>
+#include <vector>
+
+// Hands out storage for objects of type T from slabs of kPerSlab
+// slots, and keeps freed slots on a free list for the next
+// allocation. Slabs are returned to the system only after Close(),
+// once the last slot in use has been freed.
+//
+// Not thread-safe: keep one per thread (each addon instance's
+// objects are created and finalized on its own thread).
+template <typename T, size_t kPerSlab = 256>
+class SlabAllocator {
+ public:
+  ~SlabAllocator() { Release(); }
+
+  // Storage for one T. `*grown` is set to the size of the slab
+  // that had to be reserved for it, or to 0.
+  void* Allocate(size_t* grown) {
+    *grown = free_ == nullptr ? Grow(kPerSlab) : 0;
+
+    Slot* slot = free_;
+    free_ = slot->next;
+    free_count_--;
+    in_use_++;
+    return slot->storage;
+  }
+
+  // Returns the size of the slabs this gave back to the system, or 0.
+  size_t Free(void* storage) {
+    Slot* slot = reinterpret_cast<Slot*>(storage);
+    slot->next = free_;
+    free_ = slot;
+    free_count_++;
+    in_use_--;
+    return closing_ && in_use_ == 0 ? Release() : 0;
+  }
+
+  // Makes sure the next `count` Allocate() calls need not grow, with
+  // one slab sized to fit instead of many small ones. Returns the
+  // size that had to be reserved, or 0.
+  size_t Reserve(size_t count) {
+    if (count <= free_count_) return 0;
+    size_t slots = (count - free_count_ + kPerSlab - 1) / kPerSlab * kPerSlab;
+    return Grow(slots);
+  }
+
+  // For an env cleanup hook: gives the slabs back to the system, now
+  // if no slot is in use, or else when the last one is freed. Cleanup
+  // hooks run before the finalizers of the env's wrappers, which may
+  // still free their slots. Returns the size given back now, or 0.
+  size_t Close() {
+    closing_ = true;
+    return in_use_ == 0 ? Release() : 0;
+  }
+
+ private:
+  union Slot {
+    Slot* next;
+    alignas(T) unsigned char storage[sizeof(T)];
+  };
+
+  size_t Grow(size_t slots) {
+    Slot* slab = new Slot[slots];
+    for (size_t i = 0; i < slots; i++) {
+      slab[i].next = i + 1 < slots ? &slab[i + 1] : free_;
+    }
+    slabs_.push_back(slab);
+    free_ = slab;
+    free_count_ += slots;
+    reserved_ += sizeof(Slot) * slots;
+    return sizeof(Slot) * slots;
+  }
+
+  size_t Release() {
+    size_t released = reserved_;
+    for (size_t i = 0; i < slabs_.size(); i++) delete[] slabs_[i];
+    slabs_.clear();
+    free_ = nullptr;
+    free_count_ = 0;
+    reserved_ = 0;
+    closing_ = false;
+    return released;
+  }
+
+  std::vector<Slot*> slabs_;  // sizes vary, see Reserve()
+  Slot* free_ = nullptr;
+  size_t free_count_ = 0;
+  size_t in_use_ = 0;
+  size_t reserved_ = 0;
+  bool closing_ = false;
+};
+
+#endif  // TEST_ADDONS_NAPI_7_FACTORY_WRAP_SLAB_ALLOCATOR_H_
@@ -1,5 +1,8 @@
+#include "expr.h"
 #include "myobject.h"
 #include <assert.h>
+#include <string.h>
+#include <vector>
 
 napi_value CreateObject(napi_env env, napi_callback_info info) {
   napi_status status;
@@ -11,6 +14,12 @@ napi_value CreateObject(napi_env env, napi_callback_info info) {
 
   napi_value instance;
   status = MyObject::NewInstance(env, args[0], &instance);
+  if (status != napi_ok) {
+    bool pending;
+    napi_is_exception_pending(env, &pending);
+    if (!pending) napi_throw_type_error(env, nullptr, "expected a number");
+    return nullptr;
+  }
 
   return instance;
 }
@@ -23,13 +32,11 @@ napi_value Add(napi_env env, napi_callback_info info) {
   status = napi_get_cb_info(env, info, &argc, args, nullptr, nullptr);
   assert(status == napi_ok);
 
-  MyObject* obj1;
-  status = napi_unwrap(env, args[0], reinterpret_cast<void**>(&obj1));
-  assert(status == napi_ok);
+  MyObject* obj1 = MyObject::Unwrap(env, args[0]);
+  if (obj1 == nullptr) return nullptr;
 
-  MyObject* obj2;
-  status = napi_unwrap(env, args[1], reinterpret_cast<void**>(&obj2));
-  assert(status == napi_ok);
+  MyObject* obj2 = MyObject::Unwrap(env, args[1]);
+  if (obj2 == nullptr) return nullptr;
 
   napi_value sum;
   status = napi_create_double(env, obj1->Val() + obj2->Val(), &sum);
@@ -38,6 +45,198 @@ napi_value Add(napi_env env, napi_callback_info info) {
   return sum;
 }
 
+// Unwraps every element of the JS array `value` into `objects`.
+// Throws and returns false if it is not an array of MyObjects.
+static bool UnwrapArray(napi_env env,
+                        napi_value value,
+                        std::vector<const MyObject*>* objects) {
+  napi_status status;
+
+  bool is_array;
+  status = napi_is_array(env, value, &is_array);
+  assert(status == napi_ok);
+  if (!is_array) {
+    napi_throw_type_error(env, nullptr, "expected an array of MyObjects");
+    return false;
+  }
+
+  uint32_t length;
+  status = napi_get_array_length(env, value, &length);
+  assert(status == napi_ok);
+  objects->resize(length);
+
+  // napi_get_element() leaves a handle behind for every element
+  const uint32_t kPerScope = 1024;
+
+  for (uint32_t first = 0; first < length; first += kPerScope) {
+    uint32_t last = length - first > kPerScope ? first + kPerScope : length;
+
+    napi_handle_scope scope;
+    status = napi_open_handle_scope(env, &scope);
+    assert(status == napi_ok);
+
+    bool ok = true;
+    for (uint32_t i = first; i < last && ok; i++) {
+      napi_value element;
+      status = napi_get_element(env, value, i, &element);
+      assert(status == napi_ok);
+
+      (*objects)[i] = MyObject::Unwrap(env, element);
+      ok = (*objects)[i] != nullptr;
+    }
+
+    status = napi_close_handle_scope(env, scope);
+    assert(status == napi_ok);
+    if (!ok) return false;
+  }
+
+  return true;
+}
+
+// The objects are spread over the heap, so fetch a few ahead of the
+// one being read instead of stalling on each in turn.
+#if defined(__GNUC__)
+#define PREFETCH(address) __builtin_prefetch(address)
+#else
+#define PREFETCH(address)
+#endif
+
+static const size_t kPrefetchDistance = 8;
+
+enum ReduceOp { kReduceSum, kReduceProduct, kReduceMin, kReduceMax };
+
+static double Reduce(const std::vector<const MyObject*>& objects, ReduceOp op) {
+  size_t count = objects.size();
+  double result = op == kReduceProduct ? 1 : 0;
+  if (count == 0) return result;
+  if (op == kReduceMin || op == kReduceMax) result = objects[0]->Val();
+
+  for (size_t i = 0; i < count; i++) {
+    if (i + kPrefetchDistance < count) PREFETCH(objects[i + kPrefetchDistance]);
+    double value = objects[i]->Val();
+    switch (op) {
+      case kReduceSum: result += value; break;
+      case kReduceProduct: result *= value; break;
+      case kReduceMin: if (value < result) result = value; break;
+      case kReduceMax: if (value > result) result = value; break;
+    }
+  }
+
+  return result;
+}
+
+static napi_value CreateDouble(napi_env env, double value) {
+  napi_value result;
+  napi_status status = napi_create_double(env, value, &result);
+  assert(status == napi_ok);
+  return result;
+}
+
+// sum(objects) adds up the values of an array of MyObjects.
+napi_value Sum(napi_env env, napi_callback_info info) {
+  napi_status status;
+
+  size_t argc = 1;
+  napi_value args[1];
+  status = napi_get_cb_info(env, info, &argc, args, nullptr, nullptr);
+  assert(status == napi_ok);
+
+  std::vector<const MyObject*> objects;
+  if (!UnwrapArray(env, args[0], &objects)) return nullptr;
+
+  return CreateDouble(env, Reduce(objects, kReduceSum));
+}
+
+// dot(a, b) is the sum of a[i].value * b[i].value.
+napi_value Dot(napi_env env, napi_callback_info info) {
+  napi_status status;
+
+  size_t argc = 2;
+  napi_value args[2];
+  status = napi_get_cb_info(env, info, &argc, args, nullptr, nullptr);
+  assert(status == napi_ok);
+
+  std::vector<const MyObject*> a;
+  std::vector<const MyObject*> b;
+  if (!UnwrapArray(env, args[0], &a) || !UnwrapArray(env, args[1], &b)) {
+    return nullptr;
+  }
+
+  if (a.size() != b.size()) {
+    napi_throw_range_error(env, nullptr, "arrays differ in length");
+    return nullptr;
+  }
+
+  double result = 0;
+  for (size_t i = 0; i < a.size(); i++) {
+    if (i + kPrefetchDistance < a.size()) {
+      PREFETCH(a[i + kPrefetchDistance]);
+      PREFETCH(b[i + kPrefetchDistance]);
+    }
+    result += a[i]->Val() * b[i]->Val();
+  }
+
+  return CreateDouble(env, result);
+}
+
+// reduce(objects, op) folds the values with op, one of 'sum',
+// 'product', 'min' or 'max'. min and max of no objects are 0.
+napi_value ReduceObjects(napi_env env, napi_callback_info info) {
+  napi_status status;
+
+  size_t argc = 2;
+  napi_value args[2];
+  status = napi_get_cb_info(env, info, &argc, args, nullptr, nullptr);
+  assert(status == napi_ok);
+
+  // longer names are cut to 15 characters, which matches no op
+  char name[16] = "";
+  size_t name_length;
+  status = napi_get_value_string_utf8(
+      env, args[1], name, sizeof(name), &name_length);
+  if (status != napi_ok) {
+    napi_throw_type_error(env, nullptr, "op must be a string");
+    return nullptr;
+  }
+
+  ReduceOp op;
+  if (strcmp(name, "sum") == 0) {
+    op = kReduceSum;
+  } else if (strcmp(name, "product") == 0) {
+    op = kReduceProduct;
+  } else if (strcmp(name, "min") == 0) {
+    op = kReduceMin;
+  } else if (strcmp(name, "max") == 0) {
+    op = kReduceMax;
+  } else {
+    napi_throw_range_error(env, nullptr, "unknown op");
+    return nullptr;
+  }
+
+  std::vector<const MyObject*> objects;
+  if (!UnwrapArray(env, args[0], &objects)) return nullptr;
+
+  return CreateDouble(env, Reduce(objects, op));
+}
+
+// inspect() returns the live-object counters of each wrapped class.
+napi_value Inspect(napi_env env, napi_callback_info info) {
+  napi_status status;
+
+  napi_value result;
+  status = napi_create_object(env, &result);
+  assert(status == napi_ok);
+
+  napi_value stats;
+  status = MyObject::Stats(env, &stats);
+  assert(status == napi_ok);
+
+  status = napi_set_named_property(env, result, "MyObject", stats);
+  assert(status == napi_ok);
+
+  return result;
+}
+
 #define DECLARE_NAPI_METHOD(name, func)                          \
   { name, 0, func, 0, 0, 0, napi_default, 0 }
 
@@ -45,10 +244,16 @@ napi_value Init(napi_env env, napi_value exports) {
   napi_status status;
 
   MyObject::Init(env);
+  status = Expr::Init(env, exports);
+  assert(status == napi_ok);
 
   napi_property_descriptor desc[] = {
       DECLARE_NAPI_METHOD("createObject", CreateObject),
       DECLARE_NAPI_METHOD("add", Add),
+      DECLARE_NAPI_METHOD("sum", Sum),
+      DECLARE_NAPI_METHOD("dot", Dot),
+      DECLARE_NAPI_METHOD("reduce", ReduceObjects),
+      DECLARE_NAPI_METHOD("inspect", Inspect),
   };
   status =
       napi_define_properties(env, exports, sizeof(desc) / sizeof(*desc), desc);
@@ -5,3 +5,32 @@ var obj2 = addon.createObject(20);
 var result = addon.add(obj1, obj2);
 
 console.log(result); // 30
+
+try {
+  addon.add(obj1, { val: 20 });
+} catch (e) {
+  console.log(e.message); // expected a MyObject
+}
+
+// whole arrays of objects in one call
+var objs = [obj1, obj2, addon.createObject(5)];
+console.log(addon.sum(objs)); // 35
+console.log(addon.dot(objs, objs)); // 525
+console.log(addon.reduce(objs, 'max')); // 20
+
+// formulas are built lazily and evaluated in one native pass;
+// (obj1 + obj2) is only computed once
+var total = addon.expr(obj1).add(obj2);
+var formula = total.mul(total).sub(addon.expr(2).mul(3));
+console.log(formula.eval()); // 894
+
+// free the native side now instead of waiting for the GC
+obj2.dispose();
+try {
+  addon.add(obj1, obj2);
+} catch (e) {
+  console.log(e.message); // MyObject has been disposed
+}
+
+// native memory held by wrapped objects, summed over all threads
+console.log(addon.inspect().MyObject.finalized); // 1
@@ -2,7 +2,7 @@
   "targets": [
     {
       "target_name": "addon",
-      "sources": [ "addon.cc", "myobject.cc" ]
+      "sources": [ "addon.cc", "expr.cc", "myobject.cc" ]
     }
   ]
 }
@@ -0,0 +1,420 @@
+#include "expr.h"
+#include <assert.h>
+#include <string.h>
+#include <map>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
+#include "myobject.h"
+
+ExprNode::~ExprNode() {
+  if (ref != nullptr) napi_delete_reference(env, ref);
+
+  // Free long chains with a loop: letting each node's destructor
+  // free its own operands would recurse once per level.
+  std::vector<std::shared_ptr<ExprNode>> pending;
+  if (a) pending.push_back(std::move(a));
+  if (b) pending.push_back(std::move(b));
+
+  while (!pending.empty()) {
+    std::shared_ptr<ExprNode> node = std::move(pending.back());
+    pending.pop_back();
+    if (node.use_count() == 1) {
+      if (node->a) pending.push_back(std::move(node->a));
+      if (node->b) pending.push_back(std::move(node->b));
+    }
+  }
+}
+
+napi_ref Expr::constructor;
+
+// Tags every Expr wrapper, to tell an Expr operand from a MyObject.
+static const napi_type_tag kExprTag = {
+  0x6578707265737369ULL, 0x3c6ef372fe94f82bULL
+};
+
+void Expr::Destructor(napi_env env, void* nativeObject, void* /*finalize_hint*/) {
+  delete reinterpret_cast<Expr*>(nativeObject);
+}
+
+#define DECLARE_NAPI_METHOD(name, func)                          \
+  { name, 0, func, 0, 0, 0, napi_default, 0 }
+
+napi_status Expr::Init(napi_env env, napi_value exports) {
+  napi_status status;
+  napi_property_descriptor properties[] = {
+      DECLARE_NAPI_METHOD("add", Add),
+      DECLARE_NAPI_METHOD("sub", Sub),
+      DECLARE_NAPI_METHOD("mul", Mul),
+      DECLARE_NAPI_METHOD("div", Div),
+      DECLARE_NAPI_METHOD("eval", Eval),
+  };
+
+  napi_value cons;
+  status = napi_define_class(env, "Expr", NAPI_AUTO_LENGTH, New, nullptr,
+                             sizeof(properties) / sizeof(*properties),
+                             properties, &cons);
+  if (status != napi_ok) return status;
+
+  status = napi_create_reference(env, cons, 1, &constructor);
+  if (status != napi_ok) return status;
+
+  napi_value create;
+  status = napi_create_function(
+      env, "expr", NAPI_AUTO_LENGTH, Create, nullptr, &create);
+  if (status != napi_ok) return status;
+
+  return napi_set_named_property(env, exports, "expr", create);
+}
+
+// Set by NewInstance() for the single New() call it makes.
+static thread_local std::shared_ptr<ExprNode>* pending_node = nullptr;
+
+napi_value Expr::New(napi_env env, napi_callback_info info) {
+  napi_status status;
+
+  napi_value jsthis;
+  status = napi_get_cb_info(env, info, nullptr, nullptr, &jsthis, nullptr);
+  assert(status == napi_ok);
+
+  if (pending_node == nullptr) {
+    napi_throw_type_error(env, nullptr, "use expr() to start an expression");
+    return nullptr;
+  }
+
+  Expr* obj = new Expr(std::move(*pending_node));
+  pending_node = nullptr;
+
+  status = napi_wrap(env,
+                     jsthis,
+                     reinterpret_cast<void*>(obj),
+                     Expr::Destructor,
+                     nullptr,  // finalize_hint
+                     nullptr);
+  assert(status == napi_ok);
+
+  status = napi_type_tag_object(env, jsthis, &kExprTag);
+  assert(status == napi_ok);
+
+  return jsthis;
+}
+
+napi_status Expr::NewInstance(napi_env env,
+                              std::shared_ptr<ExprNode> node,
+                              napi_value* instance) {
+  napi_status status;
+
+  napi_value cons;
+  status = napi_get_reference_value(env, constructor, &cons);
+  if (status != napi_ok) return status;
+
+  pending_node = &node;
+  status = napi_new_instance(env, cons, 0, nullptr, instance);
+  pending_node = nullptr;
+  return status;
+}
+
+// The node for an operand: a number, a MyObject or an Expr.
+bool Expr::ToNode(napi_env env,
+                  napi_value value,
+                  std::shared_ptr<ExprNode>* node) {
+  napi_status status;
+
+  napi_valuetype valuetype;
+  status = napi_typeof(env, value, &valuetype);
+  assert(status == napi_ok);
+
+  if (valuetype == napi_number) {
+    node->reset(new ExprNode(ExprNode::kConst));
+    status = napi_get_value_double(env, value, &(*node)->value);
+    assert(status == napi_ok);
+    return true;
+  }
+
+  bool is_expr;
+  status = napi_check_object_type_tag(env, value, &kExprTag, &is_expr);
+  if (status == napi_ok && is_expr) {
+    Expr* expr;
+    status = napi_unwrap(env, value, reinterpret_cast<void**>(&expr));
+    assert(status == napi_ok);
+    *node = expr->node_;
+    return true;
+  }
+
+  if (MyObject::Unwrap(env, value,
+                       "operands must be numbers, MyObjects or expressions") ==
+      nullptr) {
+    return false;
+  }
+
+  node->reset(new ExprNode(ExprNode::kLoad));
+  (*node)->env = env;
+  status = napi_create_reference(env, value, 1, &(*node)->ref);
+  assert(status == napi_ok);
+  return true;
+}
+
+// expr(x) starts an expression from a MyObject or a number.
+napi_value Expr::Create(napi_env env, napi_callback_info info) {
+  napi_status status;
+
+  size_t argc = 1;
+  napi_value args[1];
+  status = napi_get_cb_info(env, info, &argc, args, nullptr, nullptr);
+  assert(status == napi_ok);
+
+  std::shared_ptr<ExprNode> node;
+  if (!ToNode(env, args[0], &node)) return nullptr;
+
+  napi_value instance;
+  status = NewInstance(env, node, &instance);
+  if (status != napi_ok) return nullptr;
+
+  return instance;
+}
+
+// add(y), sub(y), mul(y) and div(y) return a new expression for
+// this op y; nothing is computed until eval().
+napi_value Expr::Binary(napi_env env,
+                        napi_callback_info info,
+                        ExprNode::Op op) {
+  napi_status status;
+
+  size_t argc = 1;
+  napi_value args[1];
+  napi_value jsthis;
+  status = napi_get_cb_info(env, info, &argc, args, &jsthis, nullptr);
+  assert(status == napi_ok);
+
+  Expr* obj;
+  status = napi_unwrap(env, jsthis, reinterpret_cast<void**>(&obj));
+  assert(status == napi_ok);
+
+  std::shared_ptr<ExprNode> operand;
+  if (!ToNode(env, args[0], &operand)) return nullptr;
+
+  std::shared_ptr<ExprNode> node(new ExprNode(op));
+  node->a = obj->node_;
+  node->b = operand;
+
+  napi_value instance;
+  status = NewInstance(env, node, &instance);
+  if (status != napi_ok) return nullptr;
+
+  return instance;
+}
+
+napi_value Expr::Add(napi_env env, napi_callback_info info) {
+  return Binary(env, info, ExprNode::kAdd);
+}
+
+napi_value Expr::Sub(napi_env env, napi_callback_info info) {
+  return Binary(env, info, ExprNode::kSub);
+}
+
+napi_value Expr::Mul(napi_env env, napi_callback_info info) {
+  return Binary(env, info, ExprNode::kMul);
+}
+
+napi_value Expr::Div(napi_env env, napi_callback_info info) {
+  return Binary(env, info, ExprNode::kDiv);
+}
+
+static double Apply(ExprNode::Op op, double a, double b) {
+  switch (op) {
+    case ExprNode::kAdd: return a + b;
+    case ExprNode::kSub: return a - b;
+    case ExprNode::kMul: return a * b;
+    case ExprNode::kDiv: return a / b;
+    default: assert(false); return 0;
+  }
+}
+
+// Flattens a DAG into steps, merging nodes that compute the same
+// thing and folding ops on constants as it goes.
+class ExprCompiler {
+ public:
+  explicit ExprCompiler(napi_env env) : env_(env), failed_(false) {}
+
+  // False after throwing if an object has been disposed.
+  bool Compile(const ExprNode* root, std::vector<ExprStep>* program) {
+    uint32_t result = Visit(root);
+    if (failed_) return false;
+    *program = Live(result);
+    return true;
+  }
+
+ private:
+  typedef std::tuple<int, uint32_t, uint32_t, uint64_t, const MyObject*> Key;
+
+  // Post-order walk with an explicit stack, so that deep chains do
+  // not overflow the native one.
+  uint32_t Visit(const ExprNode* root) {
+    std::vector<std::pair<const ExprNode*, bool> > stack;
+    stack.push_back(std::make_pair(root, false));
+
+    while (!stack.empty() && !failed_) {
+      const ExprNode* node = stack.back().first;
+      bool operands_done = stack.back().second;
+
+      if (visited_.count(node)) {
+        stack.pop_back();
+      } else if (node->a && !operands_done) {
+        stack.back().second = true;
+        stack.push_back(std::make_pair(node->a.get(), false));
+        stack.push_back(std::make_pair(node->b.get(), false));
+      } else {
+        stack.pop_back();
+        visited_[node] = node->a ? Emit(node->op,
+                                        visited_[node->a.get()],
+                                        visited_[node->b.get()])
+                                 : Leaf(node);
+      }
+    }
+
+    return visited_[root];
+  }
+
+  uint32_t Leaf(const ExprNode* node) {
+    // Loads are merged by the MyObject their wrapper holds now. No two
+    // wrappers hold the same one at once, but a disposed object's
+    // memory may since have gone to another, so the pointer taken
+    // when the load was added says nothing.
+    const MyObject* object = nullptr;
+    if (node->op == ExprNode::kLoad) {
+      napi_value wrapper;
+      napi_status status = napi_get_reference_value(env_, node->ref, &wrapper);
+      assert(status == napi_ok);
+
+      object = MyObject::Unwrap(env_, wrapper);
+      if (object == nullptr) {
+        failed_ = true;
+        return 0;
+      }
+    }
+
+    ExprStep step = { node->op, 0, 0, node->value, object, node->ref };
+    return Intern(step);
+  }
+
+  uint32_t Constant(double value) {
+    ExprStep step = { ExprNode::kConst, 0, 0, value, nullptr, nullptr };
+    return Intern(step);
+  }
+
+  bool IsConstant(uint32_t reg, double value) const {
+    return steps_[reg].op == ExprNode::kConst && steps_[reg].value == value;
+  }
+
+  uint32_t Emit(ExprNode::Op op, uint32_t a, uint32_t b) {
+    if (steps_[a].op == ExprNode::kConst && steps_[b].op == ExprNode::kConst) {
+      return Constant(Apply(op, steps_[a].value, steps_[b].value));
+    }
+
+    // x * 1 and x / 1 are exactly x, even for NaN and -0
+    if ((op == ExprNode::kMul || op == ExprNode::kDiv) && IsConstant(b, 1)) {
+      return a;
+    }
+    if (op == ExprNode::kMul && IsConstant(a, 1)) return b;
+
+    // so that a + b and b + a are recognized as the same value
+    if ((op == ExprNode::kAdd || op == ExprNode::kMul) && a > b) {
+      std::swap(a, b);
+    }
+
+    ExprStep step = { op, a, b, 0, nullptr, nullptr };
+    return Intern(step);
+  }
+
+  uint32_t Intern(const ExprStep& step) {
+    uint64_t bits;
+    memcpy(&bits, &step.value, sizeof(bits));
+    Key key(step.op, step.a, step.b, bits, step.object);
+
+    std::map<Key, uint32_t>::iterator it = seen_.find(key);
+    if (it != seen_.end()) return it->second;
+
+    uint32_t reg = static_cast<uint32_t>(steps_.size());
+    steps_.push_back(step);
+    seen_[key] = reg;
+    return reg;
+  }
+
+  // Drops the steps folding has left unused; `result` ends up last.
+  std::vector<ExprStep> Live(uint32_t result) {
+    std::vector<bool> live(steps_.size(), false);
+    live[result] = true;
+    for (uint32_t i = result + 1; i-- > 0;) {
+      if (live[i] && steps_[i].op > ExprNode::kLoad) {
+        live[steps_[i].a] = true;
+        live[steps_[i].b] = true;
+      }
+    }
+
+    std::vector<uint32_t> renamed(steps_.size());
+    std::vector<ExprStep> program;
+    for (uint32_t i = 0; i <= result; i++) {
+      if (!live[i]) continue;
+      ExprStep step = steps_[i];
+      step.a = renamed[step.a];
+      step.b = renamed[step.b];
+      renamed[i] = static_cast<uint32_t>(program.size());
+      program.push_back(step);
+    }
+    return program;
+  }
+
+  napi_env env_;
+  bool failed_;
+  std::vector<ExprStep> steps_;
+  std::map<Key, uint32_t> seen_;
+  std::unordered_map<const ExprNode*, uint32_t> visited_;
+};
+
+// eval() computes the expression from the objects' current values.
+napi_value Expr::Eval(napi_env env, napi_callback_info info) {
+  napi_status status;
+
+  napi_value jsthis;
+  status = napi_get_cb_info(env, info, nullptr, nullptr, &jsthis, nullptr);
+  assert(status == napi_ok);
+
+  Expr* obj;
+  status = napi_unwrap(env, jsthis, reinterpret_cast<void**>(&obj));
+  assert(status == napi_ok);
+
+  // the DAG never changes, so compile it only once
+  if (obj->program_.empty()) {
+    if (!ExprCompiler(env).Compile(obj->node_.get(), &obj->program_)) {
+      return nullptr;
+    }
+  }
+
+  const std::vector<ExprStep>& program = obj->program_;
+  std::vector<double> regs(program.size());
+
+  for (size_t i = 0; i < program.size(); i++) {
+    const ExprStep& step = program[i];
+    switch (step.op) {
+      case ExprNode::kConst: regs[i] = step.value; break;
+      case ExprNode::kLoad: {
+        // the object may have been disposed since it was added
+        napi_value wrapper;
+        status = napi_get_reference_value(env, step.ref, &wrapper);
+        assert(status == napi_ok);
+
+        const MyObject* object = MyObject::Unwrap(env, wrapper);
+        if (object == nullptr) return nullptr;
+        regs[i] = object->Val();
+        break;
+      }
+      default: regs[i] = Apply(step.op, regs[step.a], regs[step.b]); break;
+    }
+  }
+
+  napi_value result;
+  status = napi_create_double(env, regs.back(), &result);
+  assert(status == napi_ok);
+
+  return result;
+}
@@ -0,0 +1,78 @@
+#ifndef TEST_ADDONS_NAPI_8_PASSING_WRAPPED_EXPR_H_
+#define TEST_ADDONS_NAPI_8_PASSING_WRAPPED_EXPR_H_
+
+#include <node_api.h>
+#include <stdint.h>
+#include <memory>
+#include <vector>
+
+class MyObject;
+
+// A node of an expression DAG. Leaves are constants or the value of
+// a MyObject, whose wrapper the node keeps alive; inner nodes apply
+// an arithmetic op to two other nodes, which may be shared.
+struct ExprNode {
+  enum Op { kConst, kLoad, kAdd, kSub, kMul, kDiv };
+
+  explicit ExprNode(Op op_)
+      : op(op_), value(0), env(nullptr), ref(nullptr) {}
+  ~ExprNode();
+
+  Op op;
+  double value;            // kConst
+  napi_env env;
+  napi_ref ref;            // kLoad: the object's wrapper
+  std::shared_ptr<ExprNode> a;
+  std::shared_ptr<ExprNode> b;
+};
+
+// The DAG flattened into straight-line code: step i writes
+// register i. Common subexpressions have been merged and constant
+// operands folded, so each distinct value is computed once.
+struct ExprStep {
+  ExprNode::Op op;
+  uint32_t a;
+  uint32_t b;
+  double value;
+  const MyObject* object;  // kLoad: held when compiled, to merge loads
+  napi_ref ref;            // kLoad: unwrapped again by every eval()
+};
+
+/*
+Lazy arithmetic over wrapped values: addon.expr(x) starts an
+expression from a MyObject or a number, add/sub/mul/div extend it
+without computing anything, and eval() compiles the whole DAG once
+and then runs it in a single native pass.
+*/
+class Expr {
+ public:
+  static napi_status Init(napi_env env, napi_value exports);
+  static void Destructor(napi_env env, void* nativeObject, void* finalize_hint);
+
+ private:
+  explicit Expr(std::shared_ptr<ExprNode> node) : node_(node) {}
+
+  static napi_status NewInstance(napi_env env,
+                                 std::shared_ptr<ExprNode> node,
+                                 napi_value* instance);
+  static bool ToNode(napi_env env,
+                     napi_value value,
+                     std::shared_ptr<ExprNode>* node);
+  static napi_value Binary(napi_env env,
+                           napi_callback_info info,
+                           ExprNode::Op op);
+
+  static napi_value Create(napi_env env, napi_callback_info info);
+  static napi_value New(napi_env env, napi_callback_info info);
+  static napi_value Add(napi_env env, napi_callback_info info);
+  static napi_value Sub(napi_env env, napi_callback_info info);
+  static napi_value Mul(napi_env env, napi_callback_info info);
+  static napi_value Div(napi_env env, napi_callback_info info);
+  static napi_value Eval(napi_env env, napi_callback_info info);
+
+  static napi_ref constructor;
+  std::shared_ptr<ExprNode> node_;
+  std::vector<ExprStep> program_;  // compiled by the first eval()
+};
+
+#endif  // TEST_ADDONS_NAPI_8_PASSING_WRAPPED_EXPR_H_
@@ -1,58 +1,152 @@
 #include "myobject.h"
 #include <assert.h>
+#include <new>
 
-MyObject::MyObject() : env_(nullptr), wrapper_(nullptr) {}
+ObjectStats MyObject::stats;
 
-MyObject::~MyObject() { napi_delete_reference(env_, wrapper_); }
+MyObject::MyObject()
+    : born_(ObjectStats::Now()), env_(nullptr), wrapper_(nullptr) {
+  stats.Constructed();
+}
+
+MyObject::~MyObject() {
+  if (wrapper_ != nullptr) {
+    napi_delete_reference(env_, wrapper_);
+    stats.RefDeleted();
+  }
+}
+
+// Nothing here reads wrapper_, so skip the reference unless asked.
+#ifdef MYOBJECT_WRAPPER_REF
+static const bool kKeepWrapperRef = true;
+#else
+static const bool kKeepWrapperRef = false;
+#endif
+
+thread_local SlabAllocator<MyObject> MyObject::allocator;
 
 void MyObject::Destructor(napi_env env, void* nativeObject, void* /*finalize_hint*/) {
-  reinterpret_cast<MyObject*>(nativeObject)->~MyObject();
+  MyObject* obj = reinterpret_cast<MyObject*>(nativeObject);
+  stats.Finalized(obj->born_);
+  obj->~MyObject();
+  size_t released = allocator.Free(obj);
+  if (released > 0) stats.Released(env, released);
+}
+
+// Env cleanup hook; see SlabAllocator::Close().
+void MyObject::ReleaseSlabs(void* arg) {
+  size_t released = allocator.Close();
+  if (released > 0) stats.Released(static_cast<napi_env>(arg), released);
 }
 
-napi_ref MyObject::constructor;
+napi_status MyObject::Stats(napi_env env, napi_value* result) {
+  return stats.ToObject(env, sizeof(MyObject), result);
+}
+
+thread_local napi_ref MyObject::constructor;
+
+// Tags every wrapper, so objects passed to add() can be checked to
+// be MyObjects, and not other objects wrapped by some other addon.
+static const napi_type_tag kMyObjectTag = {
+  0x6f626a5f77726170ULL, 0x8a5cd789635d2dffULL
+};
+
+// Symbol.dispose, so `using` declarations dispose of MyObjects;
+// NULL where the runtime does not define it.
+static napi_value GetDisposeSymbol(napi_env env) {
+  napi_status status;
+
+  napi_value global, symbol, dispose;
+  status = napi_get_global(env, &global);
+  assert(status == napi_ok);
+  status = napi_get_named_property(env, global, "Symbol", &symbol);
+  assert(status == napi_ok);
+  status = napi_get_named_property(env, symbol, "dispose", &dispose);
+  assert(status == napi_ok);
+
+  napi_valuetype valuetype;
+  status = napi_typeof(env, dispose, &valuetype);
+  assert(status == napi_ok);
+
+  return valuetype == napi_symbol ? dispose : nullptr;
+}
 
 napi_status MyObject::Init(napi_env env) {
   napi_status status;
+  napi_property_descriptor properties[] = {
+      { "dispose", 0, Dispose, 0, 0, 0, napi_default, 0 },
+      // keep last: left out where there is no Symbol.dispose
+      { nullptr, GetDisposeSymbol(env), Dispose, 0, 0, 0, napi_default, 0 },
+  };
+  size_t property_count = sizeof(properties) / sizeof(*properties);
+  if (properties[property_count - 1].name == nullptr) property_count--;
 
   napi_value cons;
-  status = napi_define_class(env, "MyObject", NAPI_AUTO_LENGTH, New, nullptr, 0, nullptr, &cons);
+  status = napi_define_class(env, "MyObject", NAPI_AUTO_LENGTH, New, nullptr,
+                             property_count, properties, &cons);
   if (status != napi_ok) return status;
 
   status = napi_create_reference(env, cons, 1, &constructor);
   if (status != napi_ok) return status;
 
+  status = napi_add_env_cleanup_hook(env, ReleaseSlabs, env);
+  if (status != napi_ok) return status;
+
   return napi_ok;
 }
 
+// Set by NewInstance() for the single New() call it makes, so the
+// value reaches the object as a double instead of being boxed into
+// a JS argument and parsed back out again.
+static thread_local const double* pending_value = nullptr;
+
 napi_value MyObject::New(napi_env env, napi_callback_info info) {
   napi_status status;
 
-  size_t argc = 1;
-  napi_value args[1];
   napi_value jsthis;
-  status = napi_get_cb_info(env, info, &argc, args, &jsthis, nullptr);
-  assert(status == napi_ok);
+  double value = 0;
 
-  MyObject* obj = new MyObject();
-
-  napi_valuetype valuetype;
-  status = napi_typeof(env, args[0], &valuetype);
-  assert(status == napi_ok);
+  if (pending_value != nullptr) {
+    status = napi_get_cb_info(env, info, nullptr, nullptr, &jsthis, nullptr);
+    assert(status == napi_ok);
 
-  if (valuetype == napi_undefined) {
-    obj->val_ = 0;
+    value = *pending_value;
+    pending_value = nullptr;
   } else {
-    status = napi_get_value_double(env, args[0], &obj->val_);
+    size_t argc = 1;
+    napi_value args[1];
+    status = napi_get_cb_info(env, info, &argc, args, &jsthis, nullptr);
+    assert(status == napi_ok);
+
+    napi_valuetype valuetype;
+    status = napi_typeof(env, args[0], &valuetype);
+    assert(status == napi_ok);
+
+    if (valuetype != napi_undefined) {
+      status = napi_get_value_double(env, args[0], &value);
+      assert(status == napi_ok);
+    }
+  }
+
+  size_t grown;
+  MyObject* obj = new (allocator.Allocate(&grown)) MyObject();
+  if (grown > 0) {
+    status = stats.Reserved(env, grown);
     assert(status == napi_ok);
   }
 
+  obj->val_ = value;
   obj->env_ = env;
   status = napi_wrap(env,
                      jsthis,
                      reinterpret_cast<void*>(obj),
                      MyObject::Destructor,
                      nullptr,  // finalize_hint
-                     &obj->wrapper_);
+                     kKeepWrapperRef ? &obj->wrapper_ : nullptr);
+  assert(status == napi_ok);
+  if (kKeepWrapperRef) stats.RefCreated();
+
+  status = napi_type_tag_object(env, jsthis, &kMyObjectTag);
   assert(status == napi_ok);
 
   return jsthis;
@@ -63,15 +157,74 @@ napi_status MyObject::NewInstance(napi_env env,
                                   napi_value* instance) {
   napi_status status;
 
-  const int argc = 1;
-  napi_value argv[argc] = {arg};
+  napi_valuetype valuetype;
+  status = napi_typeof(env, arg, &valuetype);
+  if (status != napi_ok) return status;
+
+  double value = 0;
+  if (valuetype != napi_undefined) {
+    status = napi_get_value_double(env, arg, &value);
+    if (status != napi_ok) return status;
+  }
+
+  return NewInstance(env, value, instance);
+}
+
+napi_status MyObject::NewInstance(napi_env env,
+                                  double value,
+                                  napi_value* instance) {
+  napi_status status;
 
   napi_value cons;
   status = napi_get_reference_value(env, constructor, &cons);
   if (status != napi_ok) return status;
 
-  status = napi_new_instance(env, cons, argc, argv, instance);
+  // N-API has no way to make a class instance without running its
+  // constructor, but with no arguments to marshal the call is cheap
+  pending_value = &value;
+  status = napi_new_instance(env, cons, 0, nullptr, instance);
+  pending_value = nullptr;
   if (status != napi_ok) return status;
 
   return napi_ok;
 }
+
+MyObject* MyObject::Unwrap(napi_env env,
+                           napi_value value,
+                           const char* message) {
+  napi_status status;
+
+  bool is_myobject;
+  status = napi_check_object_type_tag(env, value, &kMyObjectTag, &is_myobject);
+  if (status != napi_ok || !is_myobject) {
+    napi_throw_type_error(env, nullptr, message);
+    return nullptr;
+  }
+
+  MyObject* obj;
+  status = napi_unwrap(env, value, reinterpret_cast<void**>(&obj));
+  if (status != napi_ok) {
+    // tagged, so it was a MyObject until dispose()
+    napi_throw_error(env, nullptr, "MyObject has been disposed");
+    return nullptr;
+  }
+
+  return obj;
+}
+
+// dispose() frees the native object now rather than once the wrapper
+// is collected, and puts its slot back on the free list. Any later
+// use of the wrapper throws; disposing it again does nothing.
+napi_value MyObject::Dispose(napi_env env, napi_callback_info info) {
+  napi_status status;
+
+  napi_value jsthis;
+  status = napi_get_cb_info(env, info, nullptr, nullptr, &jsthis, nullptr);
+  assert(status == napi_ok);
+
+  MyObject* obj;
+  status = napi_remove_wrap(env, jsthis, reinterpret_cast<void**>(&obj));
+  if (status == napi_ok) Destructor(env, obj, nullptr);
+
+  return nullptr;
+}
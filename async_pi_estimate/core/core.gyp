@@ -0,0 +1,23 @@
+{
+  "targets": [
+    {
+      "target_name": "pi_est",
+      "type": "static_library",
+      "sources": [
+        "pi_est.cc",
+        "kernels.cc",
+        "integrands.cc",
+        "expression.cc",
+        "parallel.cc"
+      ],
+      "direct_dependent_settings": {
+        "include_dirs": ["."]
+      },
+      "conditions": [
+        ['OS!="win"', {
+          "cflags": ["-fPIC"]
+        }]
+      ]
+    }
+  ]
+}
@@ -0,0 +1,443 @@
+#include <cctype>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include "expression.h"  // NOLINT(build/include)
+
+enum Op {
+  kConst,
+  kNeg, kNot, kSqrt, kExp, kLog, kSin, kCos, kAbs,
+  kAdd, kSub, kMul, kDiv, kPow,
+  kLt, kLe, kGt, kGe, kEq, kNe, kAnd, kOr
+};
+
+// Coordinates are compiled into the first kMaxDims registers and
+// moved down to the first `dims` once the parse is done.
+static const int kMaxDims = 16;
+static const int kMaxRegisters = 64;
+// Parentheses and unary operators need no registers, so this bounds
+// how deep they can nest, and with it the parser's own recursion.
+static const int kMaxDepth = 256;
+
+/*
+Recursive descent parser that emits code as it goes. Every
+sub-expression leaves its value in a register; temporaries are
+handed out like a stack, so the register count is bounded by the
+nesting depth of the expression.
+*/
+
+class Parser {
+ public:
+  Parser(const std::string& source, Program* program, std::string* error)
+    : src_(source.c_str()), pos_(0), program_(program), error_(error),
+      dims_(0), next_temp_(kMaxDims), max_temp_(kMaxDims), depth_(0),
+      failed_(false) {}
+
+  bool Parse() {
+    int result = Or();
+    Skip();
+    if (!failed_ && src_[pos_] != '\0') Fail("unexpected input");
+    if (failed_) return false;
+
+    // make sure the result is a temporary we may read freely
+    if (result < kMaxDims) result = Emit(kAdd, result, Constant(0));
+
+    if (dims_ == 0) dims_ = 1;
+    for (size_t i = 0; i < program_->code.size(); i++) {
+      Instruction& ins = program_->code[i];
+      ins.dst = Renumber(ins.dst);
+      ins.a = Renumber(ins.a);
+      ins.b = Renumber(ins.b);
+    }
+    program_->dims = dims_;
+    program_->registers = Renumber(max_temp_);
+    program_->result = Renumber(result);
+    return true;
+  }
+
+ private:
+  int Or() {
+    int r = And();
+    while (Match("||")) r = Emit(kOr, r, And());
+    return r;
+  }
+
+  int And() {
+    int r = Compare();
+    while (Match("&&")) r = Emit(kAnd, r, Compare());
+    return r;
+  }
+
+  int Compare() {
+    int r = Sum();
+    if (Match("<=")) return Emit(kLe, r, Sum());
+    if (Match(">=")) return Emit(kGe, r, Sum());
+    if (Match("==")) return Emit(kEq, r, Sum());
+    if (Match("!=")) return Emit(kNe, r, Sum());
+    if (Match("<")) return Emit(kLt, r, Sum());
+    if (Match(">")) return Emit(kGt, r, Sum());
+    return r;
+  }
+
+  int Sum() {
+    int r = Product();
+    for (;;) {
+      if (Match("+")) r = Emit(kAdd, r, Product());
+      else if (Match("-")) r = Emit(kSub, r, Product());
+      else return r;
+    }
+  }
+
+  int Product() {
+    int r = Unary();
+    for (;;) {
+      if (Match("*")) r = Emit(kMul, r, Unary());
+      else if (Match("/")) r = Emit(kDiv, r, Unary());
+      else return r;
+    }
+  }
+
+  // Every recursion of the parser passes through here.
+  int Unary() {
+    if (depth_ >= kMaxDepth) {
+      Fail("expression is nested too deeply");
+      return 0;
+    }
+    depth_++;
+    int r = UnaryOperand();
+    depth_--;
+    return r;
+  }
+
+  int UnaryOperand() {
+    if (Match("-")) return Emit(kNeg, Unary());
+    if (Match("+")) return Unary();
+    if (Match("!")) return Emit(kNot, Unary());
+    return Power();
+  }
+
+  int Power() {
+    int r = Primary();
+    // right associative, binds tighter than unary minus on its left
+    if (Match("^")) {
+      int n = SmallIntegerExponent();
+      r = n >= 0 ? EmitPower(r, n) : Emit(kPow, r, Unary());
+    }
+    return r;
+  }
+
+  // x^2 and friends are far cheaper as multiplications than as
+  // pow() calls; returns -1 unless the exponent is such a literal.
+  int SmallIntegerExponent() {
+    Skip();
+    const char* start = src_ + pos_;
+    if (!isdigit(*start)) return -1;
+
+    char* end;
+    double value = strtod(start, &end);
+    const char* next = end;
+    while (isspace(*next)) next++;
+    if (value != static_cast<int>(value) || value > 8 || *next == '^') {
+      return -1;
+    }
+
+    pos_ += end - start;
+    return static_cast<int>(value);
+  }
+
+  int EmitPower(int r, int n) {
+    if (n == 0) {
+      Release(r);
+      return Constant(1);
+    }
+    if (n == 1) return r;
+    if (n == 2) return Emit(kMul, r, r);
+
+    // accumulate above r, then write the last product over r
+    int acc = Alloc();
+    Push(kMul, acc, r, r);
+    for (int k = 3; k < n; k++) Push(kMul, acc, acc, r);
+    Release(acc);
+    Release(r);
+    int dst = Alloc();
+    Push(kMul, dst, acc, r);
+    return dst;
+  }
+
+  int Primary() {
+    Skip();
+    if (failed_) return 0;
+
+    const char* start = src_ + pos_;
+    if (isdigit(*start) || *start == '.') {
+      char* end;
+      double value = strtod(start, &end);
+      pos_ += end - start;
+      return Constant(value);
+    }
+
+    if (Match("(")) {
+      int r = Or();
+      if (!Match(")")) Fail("expected ')'");
+      return r;
+    }
+
+    if (isalpha(*start)) {
+      size_t len = 0;
+      while (isalnum(start[len]) || start[len] == '_') len++;
+      std::string name(start, len);
+      pos_ += len;
+      return Identifier(name);
+    }
+
+    Fail("unexpected input");
+    return 0;
+  }
+
+  int Identifier(const std::string& name) {
+    if (name == "pi") return Constant(3.14159265358979323846);
+    if (name == "e") return Constant(2.71828182845904523536);
+
+    static const struct { const char* name; Op op; } kFunctions[] = {
+      { "sqrt", kSqrt }, { "exp", kExp }, { "log", kLog },
+      { "sin", kSin }, { "cos", kCos }, { "abs", kAbs },
+    };
+    for (size_t i = 0; i < sizeof(kFunctions) / sizeof(*kFunctions); i++) {
+      if (name != kFunctions[i].name) continue;
+      if (!Match("(")) Fail("expected '(' after " + name);
+      int r = Or();
+      if (!Match(")")) Fail("expected ')'");
+      return Emit(kFunctions[i].op, r);
+    }
+
+    int dim = -1;
+    if (name.size() == 1 && strchr("xyzw", name[0]) != NULL) {
+      dim = name[0] == 'w' ? 3 : name[0] - 'x';
+    } else if (name[0] == 'x' && name.size() <= 3 &&
+               name.find_first_not_of("0123456789", 1) == std::string::npos) {
+      dim = atoi(name.c_str() + 1);
+    }
+    if (dim < 0 || dim >= kMaxDims) {
+      Fail("unknown identifier '" + name + "'");
+      return 0;
+    }
+
+    if (dim + 1 > dims_) dims_ = dim + 1;
+    return dim;
+  }
+
+  int Constant(double value) {
+    int dst = Alloc();
+    Instruction ins = { kConst, static_cast<uint8_t>(dst), 0, 0, value };
+    program_->code.push_back(ins);
+    return dst;
+  }
+
+  int Emit(Op op, int a, int b = 0) {
+    if (failed_) return 0;
+    Release(b);
+    Release(a);
+    int dst = Alloc();
+    Push(op, dst, a, b);
+    return dst;
+  }
+
+  void Push(Op op, int dst, int a, int b) {
+    Instruction ins = { static_cast<uint8_t>(op), static_cast<uint8_t>(dst),
+                        static_cast<uint8_t>(a), static_cast<uint8_t>(b), 0 };
+    program_->code.push_back(ins);
+  }
+
+  int Alloc() {
+    if (next_temp_ >= kMaxRegisters) {
+      Fail("expression is nested too deeply");
+      return 0;
+    }
+    int r = next_temp_++;
+    if (next_temp_ > max_temp_) max_temp_ = next_temp_;
+    return r;
+  }
+
+  void Release(int r) {
+    if (r >= kMaxDims && r == next_temp_ - 1) next_temp_--;
+  }
+
+  int Renumber(int r) const {
+    return r < kMaxDims ? r : r - kMaxDims + dims_;
+  }
+
+  void Skip() {
+    while (isspace(src_[pos_])) pos_++;
+  }
+
+  bool Match(const char* token) {
+    Skip();
+    size_t len = strlen(token);
+    if (failed_ || strncmp(src_ + pos_, token, len) != 0) return false;
+    pos_ += len;
+    return true;
+  }
+
+  void Fail(const std::string& message) {
+    if (failed_) return;
+    failed_ = true;
+    char at[32];
+    snprintf(at, sizeof(at), " at position %u", static_cast<unsigned>(pos_));
+    *error_ = message + at;
+  }
+
+  const char* src_;
+  size_t pos_;
+  Program* program_;
+  std::string* error_;
+  int dims_;
+  int next_temp_;
+  int max_temp_;
+  int depth_;
+  bool failed_;
+};
+
+/*
+The interpreter: sample kBatch points, then run the program one
+instruction at a time over all of them.
+*/
+
+static const int kBatch = 32 * kLanes;
+
+static PI_EST_ALWAYS_INLINE void Execute(const Instruction& ins,
+                                         double* regs) {
+  double* d = regs + ins.dst * kBatch;
+  const double* a = regs + ins.a * kBatch;
+  const double* b = regs + ins.b * kBatch;
+  int i;
+
+  switch (ins.op) {
+    case kConst: for (i = 0; i < kBatch; i++) d[i] = ins.imm; break;
+    case kNeg: for (i = 0; i < kBatch; i++) d[i] = -a[i]; break;
+    case kNot: for (i = 0; i < kBatch; i++) d[i] = a[i] == 0; break;
+    case kSqrt: for (i = 0; i < kBatch; i++) d[i] = std::sqrt(a[i]); break;
+    case kExp: for (i = 0; i < kBatch; i++) d[i] = std::exp(a[i]); break;
+    case kLog: for (i = 0; i < kBatch; i++) d[i] = std::log(a[i]); break;
+    case kSin: for (i = 0; i < kBatch; i++) d[i] = std::sin(a[i]); break;
+    case kCos: for (i = 0; i < kBatch; i++) d[i] = std::cos(a[i]); break;
+    case kAbs: for (i = 0; i < kBatch; i++) d[i] = std::fabs(a[i]); break;
+    case kAdd: for (i = 0; i < kBatch; i++) d[i] = a[i] + b[i]; break;
+    case kSub: for (i = 0; i < kBatch; i++) d[i] = a[i] - b[i]; break;
+    case kMul: for (i = 0; i < kBatch; i++) d[i] = a[i] * b[i]; break;
+    case kDiv: for (i = 0; i < kBatch; i++) d[i] = a[i] / b[i]; break;
+    case kPow: for (i = 0; i < kBatch; i++) d[i] = std::pow(a[i], b[i]); break;
+    case kLt: for (i = 0; i < kBatch; i++) d[i] = a[i] < b[i]; break;
+    case kLe: for (i = 0; i < kBatch; i++) d[i] = a[i] <= b[i]; break;
+    case kGt: for (i = 0; i < kBatch; i++) d[i] = a[i] > b[i]; break;
+    case kGe: for (i = 0; i < kBatch; i++) d[i] = a[i] >= b[i]; break;
+    case kEq: for (i = 0; i < kBatch; i++) d[i] = a[i] == b[i]; break;
+    case kNe: for (i = 0; i < kBatch; i++) d[i] = a[i] != b[i]; break;
+    case kAnd:
+      for (i = 0; i < kBatch; i++) d[i] = (a[i] != 0) & (b[i] != 0);
+      break;
+    case kOr:
+      for (i = 0; i < kBatch; i++) d[i] = (a[i] != 0) | (b[i] != 0);
+      break;
+  }
+}
+
+static PI_EST_ALWAYS_INLINE uint64_t RunProgram(const Program& program,
+                                                uint32_t seed,
+                                                uint64_t points) {
+  std::vector<double> storage(program.registers * kBatch);
+  double* regs = &storage[0];
+  uint32_t s[kMaxDims][kLanes];
+
+  for (int d = 0; d < program.dims; d++) {
+    for (int l = 0; l < kLanes; l++) s[d][l] = SeedStream(seed, d * kLanes + l);
+  }
+
+  uint64_t inside = 0;
+
+  while (points > 0) {
+    uint64_t n = points < kBatch ? points : kBatch;
+    points -= n;
+
+    for (int d = 0; d < program.dims; d++) {
+      double* u = regs + d * kBatch;
+      for (int i = 0; i < kBatch; i += kLanes) {
+        for (int l = 0; l < kLanes; l++) {
+          s[d][l] = XorShift32(s[d][l]);
+          u[i + l] = ToUnit(s[d][l]);
+        }
+      }
+    }
+
+    for (size_t i = 0; i < program.code.size(); i++) {
+      Execute(program.code[i], regs);
+    }
+
+    const double* result = regs + program.result * kBatch;
+    for (uint64_t i = 0; i < n; i++) inside += result[i] != 0;
+  }
+
+  return inside;
+}
+
+// One CountInsideFn per tier, indexed by KernelTierId.
+struct ExpressionKernels {
+  static uint64_t Scalar(const void* data, uint32_t seed, uint64_t points) {
+    return RunProgram(*static_cast<const Program*>(data), seed, points);
+  }
+
+#ifdef PI_EST_X86_DISPATCH
+  __attribute__((target("avx2")))
+  static uint64_t Avx2(const void* data, uint32_t seed, uint64_t points) {
+    return RunProgram(*static_cast<const Program*>(data), seed, points);
+  }
+
+  __attribute__((target("avx512f,avx512dq,avx512vl")))
+  static uint64_t Avx512(const void* data, uint32_t seed, uint64_t points) {
+    return RunProgram(*static_cast<const Program*>(data), seed, points);
+  }
+#endif
+
+  static const CountInsideFn kTable[kKernelTierCount];
+};
+
+// the batch loops vectorize on their own, so the baseline build
+// serves both the vector and the scalar tier
+const CountInsideFn ExpressionKernels::kTable[kKernelTierCount] = {
+#ifdef PI_EST_X86_DISPATCH
+  Avx512,
+  Avx2,
+#endif
+  Scalar,
+  Scalar,
+};
+
+ExpressionIntegrand* ExpressionIntegrand::Compile(const std::string& source,
+                                                  std::string* error) {
+  ExpressionIntegrand* expression = new ExpressionIntegrand();
+  Parser parser(source, &expression->program_, error);
+  if (!parser.Parse()) {
+    delete expression;
+    return NULL;
+  }
+
+  expression->source_ = source;
+  expression->integrand_.name = expression->source_.c_str();
+  expression->integrand_.dims = expression->program_.dims;
+  expression->integrand_.scale = 1;
+  expression->integrand_.kernels = ExpressionKernels::kTable;
+  expression->integrand_.data = &expression->program_;
+  return expression;
+}
+
+const Integrand* ResolveIntegrand(const std::string& source,
+                                  ExpressionIntegrand** compiled,
+                                  std::string* error) {
+  *compiled = NULL;
+
+  const Integrand* integrand = FindIntegrand(source.c_str());
+  if (integrand != NULL) return integrand;
+
+  *compiled = ExpressionIntegrand::Compile(source, error);
+  return *compiled != NULL ? &(*compiled)->integrand() : NULL;
+}
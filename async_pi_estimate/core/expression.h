@@ -0,0 +1,68 @@
+#ifndef EXAMPLES_ASYNC_PI_ESTIMATE_CORE_EXPRESSION_H_
+#define EXAMPLES_ASYNC_PI_ESTIMATE_CORE_EXPRESSION_H_
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include "integrands.h"  // NOLINT(build/include)
+
+/*
+User integrands written as small expressions over the sample
+coordinates, e.g. "x*x + y*y <= 1". A sample is inside when the
+expression is non-zero.
+
+Coordinates are uniform in [0,1): `x`, `y`, `z`, `w` or `x0` ..
+`x15`. Supported are numbers, `pi`, `e`, + - * / ^, comparisons
+(< <= > >= == !=), && || !, parentheses and the functions sqrt,
+exp, log, sin, cos and abs.
+
+The source is compiled once into register bytecode. The worker
+thread then runs each instruction over a whole batch of samples
+at a time, so the per-instruction dispatch is amortized and the
+inner loops vectorize.
+*/
+
+struct Instruction {
+  uint8_t op;
+  uint8_t dst;
+  uint8_t a;
+  uint8_t b;
+  double imm;
+};
+
+struct Program {
+  int dims;        // registers [0, dims) hold the coordinates
+  int registers;   // total registers used
+  int result;      // register holding the outcome
+  std::vector<Instruction> code;
+};
+
+class ExpressionIntegrand {
+ public:
+  // NULL on a syntax error, which is then described in `error`.
+  static ExpressionIntegrand* Compile(const std::string& source,
+                                      std::string* error);
+
+  const Integrand& integrand() const { return integrand_; }
+  const Program& program() const { return program_; }
+
+ private:
+  ExpressionIntegrand() {}
+  // integrand_ points into program_, so never copy
+  ExpressionIntegrand(const ExpressionIntegrand&);
+  ExpressionIntegrand& operator=(const ExpressionIntegrand&);
+
+  std::string source_;
+  Program program_;
+  Integrand integrand_;
+};
+
+// Looks `source` up in the registry of native integrands, and
+// compiles it as an expression if it is not a registered name.
+// `*compiled` then owns the result and must be deleted by the
+// caller once it is done integrating; it is NULL otherwise.
+const Integrand* ResolveIntegrand(const std::string& source,
+                                  ExpressionIntegrand** compiled,
+                                  std::string* error);
+
+#endif  // EXAMPLES_ASYNC_PI_ESTIMATE_CORE_EXPRESSION_H_
@@ -0,0 +1,162 @@
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include "integrands.h"  // NOLINT(build/include)
+
+/*
+The regions below only say what "inside" means for one sample
+in the unit box; sampling, CPU dispatch and chunking are shared.
+*/
+
+// Quarter of the unit n-ball in [0,1]^N. Scaled by 2^N this is
+// the volume of the whole ball; N = 2 is π.
+template <int N>
+struct UnitBall {
+  static const int kDims = N;
+  static double Scale() { return std::ldexp(1.0, N); }
+
+  template <int Lanes>
+  static PI_EST_ALWAYS_INLINE bool Inside(const double (&u)[N][Lanes], int l) {
+    double r2 = 0;
+    for (int d = 0; d < N; d++) r2 += u[d][l] * u[d][l];
+    return r2 <= 1;
+  }
+};
+
+// Area under the standard normal density on [K, K + kWidth],
+// which is P(Z > K) to well below sampling error.
+template <int K>
+struct GaussTail {
+  static const int kDims = 2;
+  static const int kWidth = 8;
+  static double Scale() {
+    return kWidth * std::exp(-0.5 * K * K) / 2.5066282746310002;  // √(2π)
+  }
+
+  template <int Lanes>
+  static PI_EST_ALWAYS_INLINE bool Inside(const double (&u)[2][Lanes], int l) {
+    // x = K + kWidth * u0, y = φ(K) * u1; test y <= φ(x)
+    double t = kWidth * u[0][l];
+    return u[1][l] <= std::exp(-(K * t + 0.5 * t * t));
+  }
+};
+
+// Area under y = x^3 on [0,1], i.e. 1/4.
+struct PolyCubic {
+  static const int kDims = 2;
+  static double Scale() { return 1; }
+
+  template <int Lanes>
+  static PI_EST_ALWAYS_INLINE bool Inside(const double (&u)[2][Lanes], int l) {
+    return u[1][l] <= u[0][l] * u[0][l] * u[0][l];
+  }
+};
+
+// Volume under z = x^2 + y^2 on [0,1]^2, i.e. 2/3. z reaches 2,
+// so the box is [0,1]^2 x [0,2].
+struct PolyParaboloid {
+  static const int kDims = 3;
+  static double Scale() { return 2; }
+
+  template <int Lanes>
+  static PI_EST_ALWAYS_INLINE bool Inside(const double (&u)[3][Lanes], int l) {
+    return 2 * u[2][l] <= u[0][l] * u[0][l] + u[1][l] * u[1][l];
+  }
+};
+
+#define INTEGRAND(name, Region)                                             \
+  { name, Region::kDims, Region::Scale(), RegionKernels<Region>::kTable, NULL }
+
+const Integrand kIntegrands[] = {
+  INTEGRAND("pi", UnitBall<2>),
+  INTEGRAND("ball1", UnitBall<1>),
+  INTEGRAND("ball2", UnitBall<2>),
+  INTEGRAND("ball3", UnitBall<3>),
+  INTEGRAND("ball4", UnitBall<4>),
+  INTEGRAND("ball5", UnitBall<5>),
+  INTEGRAND("ball6", UnitBall<6>),
+  INTEGRAND("ball7", UnitBall<7>),
+  INTEGRAND("ball8", UnitBall<8>),
+  INTEGRAND("ball9", UnitBall<9>),
+  INTEGRAND("ball10", UnitBall<10>),
+  INTEGRAND("ball11", UnitBall<11>),
+  INTEGRAND("ball12", UnitBall<12>),
+  INTEGRAND("ball13", UnitBall<13>),
+  INTEGRAND("ball14", UnitBall<14>),
+  INTEGRAND("ball15", UnitBall<15>),
+  INTEGRAND("ball16", UnitBall<16>),
+  INTEGRAND("gauss_tail1", GaussTail<1>),
+  INTEGRAND("gauss_tail2", GaussTail<2>),
+  INTEGRAND("gauss_tail3", GaussTail<3>),
+  INTEGRAND("gauss_tail4", GaussTail<4>),
+  INTEGRAND("poly_cubic", PolyCubic),
+  INTEGRAND("poly_paraboloid", PolyParaboloid),
+};
+
+const size_t kIntegrandCount = sizeof(kIntegrands) / sizeof(*kIntegrands);
+
+const Integrand* FindIntegrand(const char* name) {
+  for (size_t i = 0; i < kIntegrandCount; i++) {
+    if (strcmp(kIntegrands[i].name, name) == 0) return &kIntegrands[i];
+  }
+  return NULL;
+}
+
+uint32_t IntegrateSeed() {
+  unsigned int randseed = 1;
+
+  // unique seed for each run, for threaded use
+#ifdef _WIN32
+  srand(randseed);
+  return rand();  // NOLINT(runtime/threadsafe_fn)
+#else
+  return rand_r(&randseed);
+#endif
+}
+
+uint32_t IntegrateChunkCount(int points) {
+  // in 64 bits, as points + kChunkPoints - 1 overflows an int
+  int64_t total = points < 0 ? 0 : points;
+  return static_cast<uint32_t>((total + (kChunkPoints - 1)) / kChunkPoints);
+}
+
+uint64_t IntegrateChunks(const Integrand& integrand,
+                         uint32_t seed,
+                         uint32_t first,
+                         uint32_t last,
+                         int points,
+                         EstimateProgress* progress) {
+  // the kernel for this CPU does the sampling, see kernels.h
+  CountInsideFn count_inside = integrand.kernels[SelectedKernelTier()];
+
+  uint64_t inside = 0;
+
+  for (uint32_t chunk = first; chunk < last; chunk++) {
+    int64_t done = static_cast<int64_t>(chunk) * kChunkPoints;
+    int n = points - done < kChunkPoints ? static_cast<int>(points - done)
+                                         : kChunkPoints;
+    uint64_t hits =
+        count_inside(integrand.data, seed + chunk * 0x9E3779B9u, n);
+    inside += hits;
+
+    if (progress != NULL) {
+      progress->inside->fetch_add(static_cast<int32_t>(hits),
+                                  std::memory_order_relaxed);
+      progress->total->fetch_add(n, std::memory_order_release);
+    }
+  }
+
+  return inside;
+}
+
+double Integrate(const Integrand& integrand,
+                 int points,
+                 EstimateProgress* progress) {
+  if (points < 0) points = 0;
+  uint32_t chunks = IntegrateChunkCount(points);
+
+  uint64_t inside =
+      IntegrateChunks(integrand, IntegrateSeed(), 0, chunks, points, progress);
+
+  return (inside / static_cast<double>(points)) * integrand.scale;
+}
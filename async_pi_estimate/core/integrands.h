@@ -0,0 +1,62 @@
+#ifndef EXAMPLES_ASYNC_PI_ESTIMATE_CORE_INTEGRANDS_H_
+#define EXAMPLES_ASYNC_PI_ESTIMATE_CORE_INTEGRANDS_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <atomic>
+#include "kernels.h"  // NOLINT(build/include)
+
+// Optional live counters for a running Integrate(). Both slots
+// are atomically added to after every chunk of samples, so
+// they can point into a SharedArrayBuffer read with Atomics.
+struct EstimateProgress {
+  std::atomic<int32_t>* inside;
+  std::atomic<int32_t>* total;
+};
+
+// A native hit-or-miss integrand: the fraction of uniform
+// samples that land inside its region, times `scale` (the
+// volume of the box the unit samples are mapped onto), is the
+// estimate of its integral.
+struct Integrand {
+  const char* name;
+  int dims;
+  double scale;
+  const CountInsideFn* kernels;  // indexed by KernelTierId
+  const void* data;              // passed to the kernels
+};
+
+// The registry: "pi", "ball1" .. "ball16" (volume of the unit
+// n-ball), "gauss_tail1" .. "gauss_tail4" (P(Z > k) for a
+// standard normal Z), "poly_cubic" and "poly_paraboloid".
+extern const Integrand kIntegrands[];
+extern const size_t kIntegrandCount;
+
+// NULL if there is no integrand called `name`.
+const Integrand* FindIntegrand(const char* name);
+
+double Integrate(const Integrand& integrand,
+                 int points,
+                 EstimateProgress* progress = NULL);
+
+// Samples are drawn in chunks of kChunkPoints, chunk `i` from its
+// own stream derived from `seed` and `i`. A run can therefore be
+// split at chunk boundaries, in any order and on any thread,
+// without changing its result.
+static const int kChunkPoints = 1 << 16;
+
+uint32_t IntegrateSeed();
+
+// How many chunks a run of `points` samples is drawn in.
+uint32_t IntegrateChunkCount(int points);
+
+// Hits in chunks [first, last) of a `points` sample run. The
+// counts are added to `progress` as each chunk completes.
+uint64_t IntegrateChunks(const Integrand& integrand,
+                         uint32_t seed,
+                         uint32_t first,
+                         uint32_t last,
+                         int points,
+                         EstimateProgress* progress);
+
+#endif  // EXAMPLES_ASYNC_PI_ESTIMATE_CORE_INTEGRANDS_H_
@@ -0,0 +1,50 @@
+#include <cstdlib>
+#include <cstring>
+#include "kernels.h"  // NOLINT(build/include)
+
+static bool Always() { return true; }
+
+#ifdef PI_EST_X86_DISPATCH
+static bool HasAvx2() {
+  __builtin_cpu_init();
+  return __builtin_cpu_supports("avx2");
+}
+
+static bool HasAvx512() {
+  __builtin_cpu_init();
+  return __builtin_cpu_supports("avx512f") &&
+         __builtin_cpu_supports("avx512dq") &&
+         __builtin_cpu_supports("avx512vl");
+}
+#endif
+
+const KernelTier kKernelTiers[kKernelTierCount] = {
+#ifdef PI_EST_X86_DISPATCH
+  { "avx512", HasAvx512 },
+  { "avx2", HasAvx2 },
+#endif
+  { "vector", Always },
+  { "scalar", Always },
+};
+
+static KernelTierId PickKernelTier() {
+  const char* forced = getenv("PI_EST_KERNEL");
+
+  for (int i = 0; i < kKernelTierCount; i++) {
+    if (!kKernelTiers[i].supported()) continue;
+    if (forced == NULL || strcmp(forced, kKernelTiers[i].name) == 0) {
+      return static_cast<KernelTierId>(i);
+    }
+  }
+
+  // unknown or unsupported name: fall back to the best tier
+  for (int i = 0; i < kKernelTierCount; i++) {
+    if (kKernelTiers[i].supported()) return static_cast<KernelTierId>(i);
+  }
+  return kTierScalar;
+}
+
+KernelTierId SelectedKernelTier() {
+  static const KernelTierId selected = PickKernelTier();
+  return selected;
+}
@@ -0,0 +1,169 @@
+#ifndef EXAMPLES_ASYNC_PI_ESTIMATE_CORE_KERNELS_H_
+#define EXAMPLES_ASYNC_PI_ESTIMATE_CORE_KERNELS_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define PI_EST_X86_DISPATCH 1
+#define PI_EST_ALWAYS_INLINE inline __attribute__((always_inline))
+#else
+#define PI_EST_ALWAYS_INLINE inline
+#endif
+
+// Counts how many of `points` random samples in the unit box
+// fall inside a region. `seed` picks the stream; `data` is the
+// integrand's own data, e.g. a compiled expression.
+typedef uint64_t (*CountInsideFn)(const void* data,
+                                  uint32_t seed,
+                                  uint64_t points);
+
+// The CPU-dispatch tiers, best first. Every region is compiled
+// once per tier; see RegionKernels below.
+enum KernelTierId {
+#ifdef PI_EST_X86_DISPATCH
+  kTierAvx512,
+  kTierAvx2,
+#endif
+  kTierVector,
+  kTierScalar,
+  kKernelTierCount
+};
+
+struct KernelTier {
+  const char* name;
+  bool (*supported)();
+};
+
+extern const KernelTier kKernelTiers[kKernelTierCount];
+
+// The first supported tier. Picked once, on first use; the
+// PI_EST_KERNEL environment variable can force a tier by name.
+KernelTierId SelectedKernelTier();
+
+/*
+Lane kernel: `Lanes` groups of independent xorshift32 streams,
+one stream per dimension, advanced in lock step so the compiler
+can keep each lane in a vector register.
+
+A region is a struct with a `kDims` constant and a static
+`Inside(u, l)` that tests lane `l` of the sample `u[kDims][Lanes]`
+whose coordinates are uniform in [0,1).
+*/
+
+static const int kLanes = 8;
+
+// Per-lane hit counters are 32 bits wide so they vectorize;
+// fold them into the 64 bit total at least this often.
+static const uint64_t kBlocksPerFlush = 1u << 24;
+
+static PI_EST_ALWAYS_INLINE uint32_t XorShift32(uint32_t s) {
+  s ^= s << 13;
+  s ^= s >> 17;
+  s ^= s << 5;
+  return s;
+}
+
+static PI_EST_ALWAYS_INLINE double ToUnit(uint32_t s) {
+  // top 24 bits -> [0,1)
+  return static_cast<int32_t>(s >> 8) * (1.0 / 16777216.0);
+}
+
+static inline uint32_t Mix32(uint32_t s) {
+  s = (s ^ (s >> 16)) * 0x85EBCA6Bu;
+  s = (s ^ (s >> 13)) * 0xC2B2AE35u;
+  return s ^ (s >> 16);
+}
+
+static inline uint32_t SeedStream(uint32_t seed, uint32_t stream) {
+  uint32_t s = Mix32(Mix32(seed) + (stream + 1) * 0x9E3779B9u);
+  // xorshift must never be seeded with zero
+  return s ? s : stream + 1;
+}
+
+template <class Region, int Lanes>
+static PI_EST_ALWAYS_INLINE uint64_t CountInsideLanes(uint32_t seed,
+                                                      uint64_t points) {
+  const int D = Region::kDims;
+  uint32_t s[D][Lanes];
+  double u[D][Lanes];
+  uint32_t hits[Lanes];
+
+  for (int d = 0; d < D; d++) {
+    for (int l = 0; l < Lanes; l++) s[d][l] = SeedStream(seed, d * Lanes + l);
+  }
+
+  uint64_t inside = 0;
+  uint64_t blocks = points / Lanes;
+
+  while (blocks > 0) {
+    uint64_t n = blocks < kBlocksPerFlush ? blocks : kBlocksPerFlush;
+    blocks -= n;
+
+    for (int l = 0; l < Lanes; l++) hits[l] = 0;
+
+    for (uint64_t b = 0; b < n; b++) {
+      for (int d = 0; d < D; d++) {
+        for (int l = 0; l < Lanes; l++) {
+          s[d][l] = XorShift32(s[d][l]);
+          u[d][l] = ToUnit(s[d][l]);
+        }
+      }
+      for (int l = 0; l < Lanes; l++) {
+        hits[l] += Region::Inside(u, l) ? 1 : 0;
+      }
+    }
+
+    for (int l = 0; l < Lanes; l++) inside += hits[l];
+  }
+
+  // leftover samples, on lane 0
+  for (uint64_t r = points % Lanes; r > 0; r--) {
+    for (int d = 0; d < D; d++) {
+      s[d][0] = XorShift32(s[d][0]);
+      u[d][0] = ToUnit(s[d][0]);
+    }
+    if (Region::Inside(u, 0))
+      inside++;
+  }
+
+  return inside;
+}
+
+// One CountInsideFn per tier for `Region`, indexed by KernelTierId.
+template <class Region>
+struct RegionKernels {
+  static uint64_t Scalar(const void*, uint32_t seed, uint64_t points) {
+    return CountInsideLanes<Region, 1>(seed, points);
+  }
+
+  static uint64_t Vector(const void*, uint32_t seed, uint64_t points) {
+    return CountInsideLanes<Region, kLanes>(seed, points);
+  }
+
+#ifdef PI_EST_X86_DISPATCH
+  __attribute__((target("avx2")))
+  static uint64_t Avx2(const void*, uint32_t seed, uint64_t points) {
+    return CountInsideLanes<Region, kLanes>(seed, points);
+  }
+
+  __attribute__((target("avx512f,avx512dq,avx512vl")))
+  static uint64_t Avx512(const void*, uint32_t seed, uint64_t points) {
+    return CountInsideLanes<Region, kLanes>(seed, points);
+  }
+#endif
+
+  static const CountInsideFn kTable[kKernelTierCount];
+};
+
+template <class Region>
+const CountInsideFn RegionKernels<Region>::kTable[kKernelTierCount] = {
+#ifdef PI_EST_X86_DISPATCH
+  Avx512,
+  Avx2,
+#endif
+  Vector,
+  Scalar,
+};
+
+#endif  // EXAMPLES_ASYNC_PI_ESTIMATE_CORE_KERNELS_H_
@@ -0,0 +1,191 @@
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "parallel.h"  // NOLINT(build/include)
+
+// How long one task should take: long enough that taking it off
+// a deque is noise, short enough to balance the tail.
+static const double kTaskSeconds = 0.002;
+
+// Never cut a run into fewer tasks than this per thread.
+static const uint32_t kMinTasksPerThread = 4;
+
+struct Task {
+  uint32_t first;  // chunk range [first, last)
+  uint32_t last;
+};
+
+class WorkDeque {
+ public:
+  void Push(const Task& task) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    tasks_.push_back(task);
+  }
+
+  // the owner takes the most recently dealt task
+  bool Pop(Task* task) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (tasks_.empty()) return false;
+    *task = tasks_.back();
+    tasks_.pop_back();
+    return true;
+  }
+
+  // thieves take the oldest one
+  bool Steal(Task* task) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (tasks_.empty()) return false;
+    *task = tasks_.front();
+    tasks_.pop_front();
+    return true;
+  }
+
+ private:
+  std::mutex mutex_;
+  std::deque<Task> tasks_;
+};
+
+struct Run {
+  const Integrand* integrand;
+  uint32_t seed;
+  int points;
+  EstimateProgress* progress;
+  std::vector<WorkDeque> deques;
+  std::atomic<uint64_t> inside;
+  // guarded by the pool's mutex
+  size_t helpers;  // pool threads that have joined so far
+  size_t active;   // of those, the ones still working
+
+  explicit Run(size_t threads)
+    : deques(threads), inside(0), helpers(0), active(0) {}
+};
+
+static void Work(Run* run, size_t self) {
+  size_t count = run->deques.size();
+  uint64_t inside = 0;
+  Task task;
+
+  for (;;) {
+    bool found = run->deques[self].Pop(&task);
+    for (size_t i = 1; !found && i < count; i++) {
+      found = run->deques[(self + i) % count].Steal(&task);
+    }
+    // nothing is ever pushed once the run has started
+    if (!found) break;
+
+    inside += IntegrateChunks(*run->integrand, run->seed, task.first,
+                              task.last, run->points, run->progress);
+  }
+
+  run->inside.fetch_add(inside, std::memory_order_relaxed);
+}
+
+/*
+The threads that help the calling thread of each run, one set for
+the whole process. Several runs at once, say from the libuv pool,
+share them instead of each starting a thread per core, and no run
+pays for starting threads. The threads are never stopped.
+*/
+class HelperPool {
+ public:
+  static HelperPool* Get() {
+    // leaked, so no thread is still using it while statics are destroyed
+    static HelperPool* pool = new HelperPool();
+    return pool;
+  }
+
+  // Works on `run` as worker 0, with up to `count` pool threads as
+  // workers 1 and on as they come free. Returns once every helper
+  // that started has finished; the others are called off.
+  void WorkWithHelpers(Run* run, size_t count) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      for (size_t i = 0; i < count; i++) queue_.push_back(run);
+    }
+    wake_.notify_all();
+
+    Work(run, 0);
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    queue_.erase(std::remove(queue_.begin(), queue_.end(), run), queue_.end());
+    done_.wait(lock, [run] { return run->active == 0; });
+  }
+
+ private:
+  HelperPool() {
+    unsigned threads = std::thread::hardware_concurrency();
+    for (unsigned i = 1; i < threads; i++) {
+      std::thread(&HelperPool::Loop, this).detach();
+    }
+  }
+
+  void Loop() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    for (;;) {
+      wake_.wait(lock, [this] { return !queue_.empty(); });
+      Run* run = queue_.front();
+      queue_.pop_front();
+      size_t self = ++run->helpers;
+      run->active++;
+
+      lock.unlock();
+      Work(run, self);
+      lock.lock();
+
+      if (--run->active == 0) done_.notify_all();
+    }
+  }
+
+  std::mutex mutex_;
+  std::condition_variable wake_;
+  std::condition_variable done_;
+  std::deque<Run*> queue_;
+};
+
+double IntegrateParallel(const Integrand& integrand,
+                         int points,
+                         EstimateProgress* progress,
+                         unsigned threads) {
+  if (points < 0) points = 0;
+  uint32_t chunks = IntegrateChunkCount(points);
+
+  if (threads == 0) threads = std::thread::hardware_concurrency();
+  if (threads > chunks) threads = chunks;
+  if (threads <= 1) return Integrate(integrand, points, progress);
+
+  Run run(threads);
+  run.integrand = &integrand;
+  run.seed = IntegrateSeed();
+  run.points = points;
+  run.progress = progress;
+
+  // measure this integrand on this machine with the first chunk
+  std::chrono::steady_clock::time_point start =
+      std::chrono::steady_clock::now();
+  run.inside = IntegrateChunks(integrand, run.seed, 0, 1, points, progress);
+  double seconds = std::chrono::duration<double>(
+      std::chrono::steady_clock::now() - start).count();
+
+  uint32_t remaining = chunks - 1;
+  double per_task = seconds > 0 ? kTaskSeconds / seconds : remaining;
+  uint32_t most = remaining / (threads * kMinTasksPerThread);
+  uint32_t chunks_per_task = per_task < 1 ? 1 : static_cast<uint32_t>(per_task);
+  if (chunks_per_task > most) chunks_per_task = most > 0 ? most : 1;
+
+  // deal contiguous runs of tasks to each thread
+  uint32_t tasks = (remaining + chunks_per_task - 1) / chunks_per_task;
+  for (uint32_t t = 0; t < tasks; t++) {
+    Task task = { 1 + t * chunks_per_task, 1 + (t + 1) * chunks_per_task };
+    if (task.last > chunks) task.last = chunks;
+    run.deques[static_cast<uint64_t>(t) * threads / tasks].Push(task);
+  }
+
+  // the calling thread steals whatever no helper gets around to
+  HelperPool::Get()->WorkWithHelpers(&run, threads - 1);
+
+  return (run.inside / static_cast<double>(points)) * integrand.scale;
+}
@@ -0,0 +1,25 @@
+#ifndef EXAMPLES_ASYNC_PI_ESTIMATE_CORE_PARALLEL_H_
+#define EXAMPLES_ASYNC_PI_ESTIMATE_CORE_PARALLEL_H_
+
+#include "integrands.h"  // NOLINT(build/include)
+
+/*
+Integrate() on all cores. The first chunk is sampled on the
+calling thread and timed; from that throughput the rest of the
+run is cut into tasks of a few milliseconds each, dealt out to
+per-thread deques. A thread works its own deque from the back and,
+once that is empty, steals from the front of the others, so a
+slow thread cannot hold up the whole run.
+
+Tasks are whole chunks, so the result is exactly the same as
+Integrate() for any thread count. `threads` of 0 means one per
+hardware thread. All but the calling thread come from one pool
+shared by every run in the process, so runs started side by side
+share the cores rather than each starting a thread per core.
+*/
+double IntegrateParallel(const Integrand& integrand,
+                         int points,
+                         EstimateProgress* progress = NULL,
+                         unsigned threads = 0);
+
+#endif  // EXAMPLES_ASYNC_PI_ESTIMATE_CORE_PARALLEL_H_
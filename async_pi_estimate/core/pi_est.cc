@@ -0,0 +1,20 @@
+#include "pi_est.h"  // NOLINT(build/include)
+
+/*
+Estimate the value of π by using a Monte Carlo method.
+Take `points` samples of random x and y values on a
+[0,1][0,1] plane. Calculating the length of the diagonal
+tells us whether the point lies inside, or outside a
+quarter circle running from 0,1 to 1,0. The ratio of the
+number of points inside to outside gives us an
+approximation of π/4.
+
+See https://en.wikipedia.org/wiki/File:Pi_30K.gif
+for a visualization of how this works.
+*/
+
+double Estimate (int points, EstimateProgress* progress) {
+  // the quarter circle is the 2-ball integrand, scaled by 4
+  static const Integrand* pi = FindIntegrand("pi");
+  return Integrate(*pi, points, progress);
+}
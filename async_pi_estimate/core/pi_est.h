@@ -0,0 +1,8 @@
+#ifndef EXAMPLES_ASYNC_PI_ESTIMATE_CORE_PI_EST_H_
+#define EXAMPLES_ASYNC_PI_ESTIMATE_CORE_PI_EST_H_
+
+#include "integrands.h"  // NOLINT(build/include)
+
+double Estimate(int points, EstimateProgress* progress = NULL);
+
+#endif  // EXAMPLES_ASYNC_PI_ESTIMATE_CORE_PI_EST_H_
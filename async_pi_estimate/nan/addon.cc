@@ -11,13 +11,19 @@ using Nan::New;
 using Nan::Set;
 
 // Expose synchronous and asynchronous access to our
-// Estimate() function
+// Estimate() and Integrate() functions
 NAN_MODULE_INIT(InitAll) {
   Set(target, New<String>("calculateSync").ToLocalChecked(),
     GetFunction(New<FunctionTemplate>(CalculateSync)).ToLocalChecked());
 
   Set(target, New<String>("calculateAsync").ToLocalChecked(),
     GetFunction(New<FunctionTemplate>(CalculateAsync)).ToLocalChecked());
+
+  Set(target, New<String>("integrateSync").ToLocalChecked(),
+    GetFunction(New<FunctionTemplate>(IntegrateSync)).ToLocalChecked());
+
+  Set(target, New<String>("integrateAsync").ToLocalChecked(),
+    GetFunction(New<FunctionTemplate>(IntegrateAsync)).ToLocalChecked());
 }
 
 NODE_MODULE(addon, InitAll)
\ No newline at end of file
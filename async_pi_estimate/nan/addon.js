@@ -18,17 +18,35 @@ function runSync() {
 }
 
 function runAsync() {
-  // how many batches should we split the work in to?
-  var batches = process.argv[3] || 16;
+  // the addon already spreads one call over all cores; more
+  // batches are only worth it to compare with older builds
+  var batches = Number(process.argv[3]) || 1;
   var ended = 0;
   var total = 0;
   var start = Date.now();
 
+  // every batch publishes its running [inside, total] counts into
+  // its own pair of slots; we can read them whenever we like
+  var progress = new Int32Array(new SharedArrayBuffer(batches * 2 * 4));
+  var timer = setInterval(function() {
+    var inside = 0;
+    var sampled = 0;
+    for (var i = 0; i < batches; i++) {
+      sampled += Atomics.load(progress, 2 * i + 1);
+      inside += Atomics.load(progress, 2 * i);
+    }
+    if (sampled > 0) {
+      console.log('\tπ ≈ ' + (4 * inside / sampled) +
+                  ' after ' + sampled + ' points');
+    }
+  }, 100);
+
   function done (err, result) {
     total += result;
 
     // have all the batches finished executing?
     if (++ended === batches) {
+      clearInterval(timer);
       printResult('Async', total / batches, Date.now() - start);
     }
   }
@@ -36,9 +54,23 @@ function runAsync() {
   // for each batch of work, request an async Estimate() for
   // a portion of the total number of calculations
   for (var i = 0; i < batches; i++) {
-    addon.calculateAsync(calculations / batches, done);
+    addon.calculateAsync(calculations / batches, done,
+                         progress.subarray(2 * i, 2 * i + 2));
   }
 }
 
+function runIntegrands() {
+  // the same engine integrates other native regions by name,
+  // or any expression over the coordinates x, y, z, ...
+  ['ball3', 'ball8', 'gauss_tail2', 'poly_cubic',
+   'y <= sin(pi * x)', 'x*x + y*y + z*z <= 1'].forEach(function(name) {
+    var start = Date.now();
+    var result = addon.integrateSync(name, calculations / 10);
+    console.log(name + ' ≈ ' + result + ' (took ' + (Date.now() - start) + 'ms)');
+  });
+  console.log();
+}
+
 runSync();
+runIntegrands();
 runAsync();
\ No newline at end of file
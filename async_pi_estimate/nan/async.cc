@@ -1,8 +1,11 @@
 #include <nan.h>
 #include "pi_est.h"  // NOLINT(build/include)
+#include "expression.h"  // NOLINT(build/include)
+#include "parallel.h"  // NOLINT(build/include)
 #include "async.h"  // NOLINT(build/include)
 
 using v8::Function;
+using v8::Int32Array;
 using v8::Local;
 using v8::Number;
 using v8::Value;
@@ -13,19 +16,37 @@ using Nan::HandleScope;
 using Nan::New;
 using Nan::Null;
 using Nan::To;
+using Nan::TypedArrayContents;
 
 class PiWorker : public AsyncWorker {
  public:
-  PiWorker(Callback *callback, int points)
-    : AsyncWorker(callback), points(points), estimate(0) {}
-  ~PiWorker() {}
+  PiWorker(Callback *callback,
+           const Integrand* integrand,
+           ExpressionIntegrand* compiled,
+           int points,
+           int32_t* counters)
+    : AsyncWorker(callback)
+    , integrand(integrand)
+    , compiled(compiled)
+    , points(points)
+    , estimate(0) {
+    progress.inside = NULL;
+    progress.total = NULL;
+    if (counters != NULL) {
+      progress.inside = reinterpret_cast<std::atomic<int32_t>*>(counters);
+      progress.total = reinterpret_cast<std::atomic<int32_t>*>(counters + 1);
+    }
+  }
+  ~PiWorker() { delete compiled; }
 
   // Executed inside the worker-thread.
   // It is not safe to access V8, or V8 data structures
   // here, so everything we need for input and output
   // should go on `this`.
   void Execute () {
-    estimate = Estimate(points);
+    // spreads the work over all cores, see parallel.h
+    estimate = IntegrateParallel(*integrand, points,
+                                 progress.inside != NULL ? &progress : NULL);
   }
 
   // Executed when the async work is complete
@@ -43,14 +64,71 @@ class PiWorker : public AsyncWorker {
   }
 
  private:
+  const Integrand* integrand;
+  ExpressionIntegrand* compiled;
   int points;
   double estimate;
+  EstimateProgress progress;
 };
 
-// Asynchronous access to the `Estimate()` function
+// Queues a worker for `integrand` with the arguments at
+// info[first] (points), info[first + 1] (callback) and the
+// optional info[first + 2] (progress counters). The worker takes
+// ownership of `compiled`.
+static void QueueWorker(const Nan::FunctionCallbackInfo<Value>& info,
+                        const Integrand* integrand,
+                        ExpressionIntegrand* compiled,
+                        int first) {
+  int points = To<int>(info[first]).FromJust();
+  int32_t* counters = NULL;
+
+  // optional Int32Array (usually over a SharedArrayBuffer) that
+  // receives the running [inside, total] counts
+  Local<Value> progress = info[first + 2];
+  if (!progress->IsUndefined()) {
+    if (!progress->IsInt32Array() || progress.As<Int32Array>()->Length() < 2) {
+      delete compiled;
+      return Nan::ThrowTypeError("progress must be an Int32Array of length 2");
+    }
+    counters = *TypedArrayContents<int32_t>(progress);
+  }
+
+  Callback *callback =
+      new Callback(To<Function>(info[first + 1]).ToLocalChecked());
+  PiWorker* worker =
+      new PiWorker(callback, integrand, compiled, points, counters);
+
+  // keep the counters' backing store alive until the worker is done
+  if (counters != NULL) worker->SaveToPersistent("progress", progress);
+
+  AsyncQueueWorker(worker);
+}
+
+// Asynchronous access to `Integrate()` for a named integrand
+// or an expression such as "x*x + y*y <= 1"
+NAN_METHOD(IntegrateAsync) {
+  if (!info[0]->IsString()) {
+    return Nan::ThrowTypeError("integrand must be a string");
+  }
+
+  ExpressionIntegrand* compiled;
+  std::string error;
+  const Integrand* integrand =
+      ResolveIntegrand(*Nan::Utf8String(info[0]), &compiled, &error);
+  if (integrand == NULL) {
+    return Nan::ThrowError(error.c_str());
+  }
+
+  QueueWorker(info, integrand, compiled, 1);
+}
+
+// Asynchronous access to the `Estimate()` function; given a
+// string first, the same as `IntegrateAsync()`
 NAN_METHOD(CalculateAsync) {
-  int points = To<int>(info[0]).FromJust();
-  Callback *callback = new Callback(To<Function>(info[1]).ToLocalChecked());
+  if (info[0]->IsString()) {
+    return IntegrateAsync(info);
+  }
 
-  AsyncQueueWorker(new PiWorker(callback, points));
+  static const Integrand* pi = FindIntegrand("pi");
+  QueueWorker(info, pi, NULL, 0);
 }
@@ -4,5 +4,6 @@
 #include <nan.h>
 
 NAN_METHOD(CalculateAsync);
+NAN_METHOD(IntegrateAsync);
 
 #endif  // EXAMPLES_ASYNC_PI_ESTIMATE_ASYNC_H_
@@ -4,11 +4,11 @@
       "target_name": "addon",
       "sources": [
         "addon.cc",
-        "pi_est.cc",
         "sync.cc",
         "async.cc"
       ],
-      "include_dirs": ["<!(node -e \"require('nan')\")"]
+      "include_dirs": ["<!(node -e \"require('nan')\")"],
+      "dependencies": ["../core/core.gyp:pi_est"]
     }
   ]
 }
@@ -1,5 +1,6 @@
 #include <nan.h>
 #include "pi_est.h"  // NOLINT(build/include)
+#include "expression.h"  // NOLINT(build/include)
 #include "sync.h"  // NOLINT(build/include)
 
 // Simple synchronous access to the `Estimate()` function
@@ -10,3 +11,25 @@ NAN_METHOD(CalculateSync) {
 
   info.GetReturnValue().Set(est);
 }
+
+// Synchronous access to `Integrate()` for a named integrand
+// or an expression such as "x*x + y*y <= 1"
+NAN_METHOD(IntegrateSync) {
+  if (!info[0]->IsString()) {
+    return Nan::ThrowTypeError("integrand must be a string");
+  }
+
+  ExpressionIntegrand* compiled;
+  std::string error;
+  const Integrand* integrand =
+      ResolveIntegrand(*Nan::Utf8String(info[0]), &compiled, &error);
+  if (integrand == NULL) {
+    return Nan::ThrowError(error.c_str());
+  }
+
+  int points = info[1]->Uint32Value();
+  double est = Integrate(*integrand, points);
+  delete compiled;
+
+  info.GetReturnValue().Set(est);
+}
@@ -4,5 +4,6 @@
 #include <nan.h>
 
 NAN_METHOD(CalculateSync);
+NAN_METHOD(IntegrateSync);
 
 #endif  // EXAMPLES_ASYNC_PI_ESTIMATE_SYNC_H_
@@ -3,10 +3,12 @@
 #include "async.h"  // NOLINT(build/include)
 
 // Expose synchronous and asynchronous access to our
-// Estimate() function
+// Estimate() and Integrate() functions
 Napi::Object Init(Napi::Env env, Napi::Object exports) {
   exports.Set(Napi::String::New(env, "calculateSync"), Napi::Function::New(env, CalculateSync));
   exports.Set(Napi::String::New(env, "calculateAsync"), Napi::Function::New(env, CalculateAsync));
+  exports.Set(Napi::String::New(env, "integrateSync"), Napi::Function::New(env, IntegrateSync));
+  exports.Set(Napi::String::New(env, "integrateAsync"), Napi::Function::New(env, IntegrateAsync));
   return exports;
 }
 
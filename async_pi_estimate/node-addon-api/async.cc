@@ -1,19 +1,41 @@
 #include <napi.h>
 #include "pi_est.h"  // NOLINT(build/include)
+#include "expression.h"  // NOLINT(build/include)
+#include "parallel.h"  // NOLINT(build/include)
 #include "async.h"  // NOLINT(build/include)
 
 class PiWorker : public Napi::AsyncWorker {
  public:
-  PiWorker(Napi::Function& callback, int points)
-    : Napi::AsyncWorker(callback), points(points), estimate(0) {}
-  ~PiWorker() {}
+  PiWorker(Napi::Function& callback,
+           const Integrand* integrand,
+           ExpressionIntegrand* compiled,
+           int points,
+           Napi::Int32Array counters)
+    : Napi::AsyncWorker(callback)
+    , integrand(integrand)
+    , compiled(compiled)
+    , points(points)
+    , estimate(0) {
+    progress.inside = NULL;
+    progress.total = NULL;
+    if (!counters.IsEmpty()) {
+      // keep the counters' backing store alive until we are done
+      countersRef = Napi::Persistent(counters);
+      int32_t* data = counters.Data();
+      progress.inside = reinterpret_cast<std::atomic<int32_t>*>(data);
+      progress.total = reinterpret_cast<std::atomic<int32_t>*>(data + 1);
+    }
+  }
+  ~PiWorker() { delete compiled; }
 
   // Executed inside the worker-thread.
   // It is not safe to access JS engine data structure
   // here, so everything we need for input and output
   // should go on `this`.
   void Execute () {
-    estimate = Estimate(points);
+    // spreads the work over all cores, see parallel.h
+    estimate = IntegrateParallel(*integrand, points,
+                                 progress.inside != NULL ? &progress : NULL);
   }
 
   // Executed when the async work is complete
@@ -25,15 +47,75 @@ class PiWorker : public Napi::AsyncWorker {
   }
 
  private:
+  const Integrand* integrand;
+  ExpressionIntegrand* compiled;
   int points;
   double estimate;
+  EstimateProgress progress;
+  Napi::Reference<Napi::Int32Array> countersRef;
 };
 
-// Asynchronous access to the `Estimate()` function
-Napi::Value CalculateAsync(const Napi::CallbackInfo& info) {
-  int points = info[0].As<Napi::Number>().Uint32Value();
-  Napi::Function callback = info[1].As<Napi::Function>();
-  PiWorker* piWorker = new PiWorker(callback, points);
+// Queues a worker for `integrand` with the arguments at
+// info[first] (points), info[first + 1] (callback) and the
+// optional info[first + 2] (progress counters). The worker takes
+// ownership of `compiled`.
+static Napi::Value QueueWorker(const Napi::CallbackInfo& info,
+                               const Integrand* integrand,
+                               ExpressionIntegrand* compiled,
+                               size_t first) {
+  int points = info[first].As<Napi::Number>().Uint32Value();
+  Napi::Function callback = info[first + 1].As<Napi::Function>();
+  Napi::Int32Array counters;
+
+  // optional Int32Array (usually over a SharedArrayBuffer) that
+  // receives the running [inside, total] counts
+  Napi::Value progress = info[first + 2];
+  if (!progress.IsUndefined()) {
+    if (!progress.IsTypedArray() ||
+        progress.As<Napi::TypedArray>().TypedArrayType() != napi_int32_array ||
+        progress.As<Napi::Int32Array>().ElementLength() < 2) {
+      delete compiled;
+      Napi::TypeError::New(info.Env(), "progress must be an Int32Array of length 2")
+          .ThrowAsJavaScriptException();
+      return info.Env().Undefined();
+    }
+    counters = progress.As<Napi::Int32Array>();
+  }
+
+  PiWorker* piWorker =
+      new PiWorker(callback, integrand, compiled, points, counters);
   piWorker->Queue();
   return info.Env().Undefined();
-}
\ No newline at end of file
+}
+
+// Asynchronous access to `Integrate()` for a named integrand
+// or an expression such as "x*x + y*y <= 1"
+Napi::Value IntegrateAsync(const Napi::CallbackInfo& info) {
+  if (!info[0].IsString()) {
+    Napi::TypeError::New(info.Env(), "integrand must be a string")
+        .ThrowAsJavaScriptException();
+    return info.Env().Undefined();
+  }
+
+  ExpressionIntegrand* compiled;
+  std::string error;
+  const Integrand* integrand = ResolveIntegrand(
+      info[0].As<Napi::String>().Utf8Value(), &compiled, &error);
+  if (integrand == NULL) {
+    Napi::Error::New(info.Env(), error).ThrowAsJavaScriptException();
+    return info.Env().Undefined();
+  }
+
+  return QueueWorker(info, integrand, compiled, 1);
+}
+
+// Asynchronous access to the `Estimate()` function; given a
+// string first, the same as `IntegrateAsync()`
+Napi::Value CalculateAsync(const Napi::CallbackInfo& info) {
+  if (info[0].IsString()) {
+    return IntegrateAsync(info);
+  }
+
+  static const Integrand* pi = FindIntegrand("pi");
+  return QueueWorker(info, pi, NULL, 0);
+}
@@ -4,5 +4,6 @@
 #include <napi.h>
 
 Napi::Value CalculateAsync(const Napi::CallbackInfo& info);
+Napi::Value IntegrateAsync(const Napi::CallbackInfo& info);
 
 #endif  // EXAMPLES_ASYNC_PI_ESTIMATE_ASYNC_H_
@@ -4,14 +4,16 @@
       "target_name": "addon",
       "sources": [
         "addon.cc",
-        "pi_est.cc",
         "sync.cc",
         "async.cc"
       ],
       'cflags!': [ '-fno-exceptions' ],
       'cflags_cc!': [ '-fno-exceptions' ],
       'include_dirs': ["<!@(node -p \"require('node-addon-api').include\")"],
-      'dependencies': ["<!(node -p \"require('node-addon-api').gyp\")"],
+      'dependencies': [
+        "<!(node -p \"require('node-addon-api').gyp\")",
+        "../core/core.gyp:pi_est"
+      ],
       'conditions': [
         ['OS=="win"', {
           "msvs_settings": {
@@ -1,6 +0,0 @@
-#ifndef EXAMPLES_ASYNC_PI_ESTIMATE_PI_EST_H_
-#define EXAMPLES_ASYNC_PI_ESTIMATE_PI_EST_H_
-
-double Estimate(int points);
-
-#endif  // EXAMPLES_ASYNC_PI_ESTIMATE_PI_EST_H_
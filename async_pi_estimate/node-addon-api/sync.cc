@@ -1,5 +1,6 @@
 #include <napi.h>
 #include "pi_est.h"  // NOLINT(build/include)
+#include "expression.h"  // NOLINT(build/include)
 #include "sync.h"  // NOLINT(build/include)
 
 // Simple synchronous access to the `Estimate()` function
@@ -10,3 +11,28 @@
 
   return Napi::Number::New(info.Env(), est);
 }
+
+// Synchronous access to `Integrate()` for a named integrand
+// or an expression such as "x*x + y*y <= 1"
+Napi::Value IntegrateSync(const Napi::CallbackInfo& info) {
+  if (!info[0].IsString()) {
+    Napi::TypeError::New(info.Env(), "integrand must be a string")
+        .ThrowAsJavaScriptException();
+    return info.Env().Undefined();
+  }
+
+  ExpressionIntegrand* compiled;
+  std::string error;
+  const Integrand* integrand = ResolveIntegrand(
+      info[0].As<Napi::String>().Utf8Value(), &compiled, &error);
+  if (integrand == NULL) {
+    Napi::Error::New(info.Env(), error).ThrowAsJavaScriptException();
+    return info.Env().Undefined();
+  }
+
+  int points = info[1].As<Napi::Number>().Uint32Value();
+  double est = Integrate(*integrand, points);
+  delete compiled;
+
+  return Napi::Number::New(info.Env(), est);
+}
@@ -1,7 +1,8 @@
 'use strict'
 
 const EventEmitter = require('events').EventEmitter
-const NativeEmitter = require('bindings')('native_emitter').NativeEmitter
+const addon = require('bindings')('native_emitter')
+const NativeEmitter = addon.NativeEmitter
 const inherits = require('util').inherits
 
 inherits(NativeEmitter, EventEmitter)
@@ -20,4 +21,6 @@ emitter.on('end', () => {
     console.log('### END ###')
 })
 
-emitter.callAndEmit()
\ No newline at end of file
+emitter.callAndEmit()
+
+console.log(addon.inspect().NativeEmitter.live) // 1
@@ -5,6 +5,15 @@
 #include "native-emitter.h"
 
 Napi::FunctionReference NativeEmitter::constructor;
+std::atomic<int64_t> NativeEmitter::constructed(0);
+std::atomic<int64_t> NativeEmitter::finalized(0);
+std::atomic<int64_t> NativeEmitter::age_total_ns(0);
+std::atomic<int64_t> NativeEmitter::age_max_ns(0);
+
+static int64_t NowNs() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now().time_since_epoch()).count();
+}
 
 Napi::Object NativeEmitter::Init(Napi::Env env, Napi::Object exports) {
   Napi::HandleScope scope(env);
@@ -17,12 +26,50 @@ Napi::Object NativeEmitter::Init(Napi::Env env, Napi::Object exports) {
   constructor.SuppressDestruct();
 
   exports.Set("NativeEmitter", func);
+  exports.Set("inspect", Napi::Function::New(env, Inspect, "inspect"));
   return exports;
 }
 
 NativeEmitter::NativeEmitter(const Napi::CallbackInfo& info)
-: Napi::ObjectWrap<NativeEmitter>(info)  {
-  // NOOP
+: Napi::ObjectWrap<NativeEmitter>(info), born_ns(NowNs())  {
+  constructed.fetch_add(1, std::memory_order_relaxed);
+  // the instance is native memory V8 does not see otherwise
+  Napi::MemoryManagement::AdjustExternalMemory(info.Env(), sizeof(*this));
+}
+
+NativeEmitter::~NativeEmitter() {
+  // N-API only tells when an object is finalized, not when it became
+  // unreachable, so its age by then stands in for finalizer lag
+  int64_t age = NowNs() - born_ns;
+  finalized.fetch_add(1, std::memory_order_relaxed);
+  age_total_ns.fetch_add(age, std::memory_order_relaxed);
+  int64_t max = age_max_ns.load(std::memory_order_relaxed);
+  while (age > max && !age_max_ns.compare_exchange_weak(max, age)) {
+  }
+
+  Napi::MemoryManagement::AdjustExternalMemory(
+      Env(), -static_cast<int64_t>(sizeof(*this)));
+}
+
+// inspect() returns the live-object counters of NativeEmitter.
+Napi::Value NativeEmitter::Inspect(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  int64_t made = constructed.load(std::memory_order_relaxed);
+  int64_t done = finalized.load(std::memory_order_relaxed);
+  double age_total = static_cast<double>(age_total_ns.load());
+
+  Napi::Object stats = Napi::Object::New(env);
+  stats.Set("live", static_cast<double>(made - done));
+  stats.Set("liveBytes",
+      static_cast<double>(made - done) * sizeof(NativeEmitter));
+  stats.Set("constructed", static_cast<double>(made));
+  stats.Set("finalized", static_cast<double>(done));
+  stats.Set("meanAgeAtFinalizeMs", done > 0 ? age_total / done / 1e6 : 0);
+  stats.Set("maxAgeAtFinalizeMs", age_max_ns.load() / 1e6);
+
+  Napi::Object result = Napi::Object::New(env);
+  result.Set("NativeEmitter", stats);
+  return result;
 }
 
 Napi::Value NativeEmitter::CallAndEmit(const Napi::CallbackInfo& info) {
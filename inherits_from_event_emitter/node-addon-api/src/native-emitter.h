@@ -1,12 +1,25 @@
 #include <napi.h>
+#include <atomic>
+#include <stdint.h>
 
 class NativeEmitter : public Napi::ObjectWrap<NativeEmitter> {
     public:
         static Napi::Object Init(Napi::Env env, Napi::Object exports);
         NativeEmitter(const Napi::CallbackInfo& info);
+        ~NativeEmitter();
 
     private:
         static Napi::FunctionReference constructor;
 
+        // Live-object counters over all threads, read by inspect().
+        static std::atomic<int64_t> constructed;
+        static std::atomic<int64_t> finalized;
+        static std::atomic<int64_t> age_total_ns;
+        static std::atomic<int64_t> age_max_ns;
+
+        static Napi::Value Inspect(const Napi::CallbackInfo& info);
+
         Napi::Value CallAndEmit(const Napi::CallbackInfo& info);
-};
\ No newline at end of file
+
+        int64_t born_ns;
+};